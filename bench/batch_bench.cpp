@@ -0,0 +1,160 @@
+//Micro-benchmark of playing many games at once: a BatchGame against looping over Game objects
+//and over Engine objects (which also parse the moves and write the logs, here to /dev/null).
+//The moves are chosen outside the timed part, only the turns themselves are timed.
+//Build and run with: make bench && ./bench/bin/batch_bench
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+
+#include "../include/engine.h"
+#include "../include/game.h"
+#include "../include/batch_game.h"
+
+namespace {
+
+constexpr std::array<Direction, 4> directions {
+    Direction::UP, Direction::RIGHT, Direction::DOWN, Direction::LEFT
+};
+
+//A simple bot: walks to the first free neighbouring cell (starting from a direction
+//that changes every turn), bombs when it can and attacks the enemy when it is in range
+template <typename CellAt>
+PlayerMove chooseMove(int x, int y, int enemyX, int enemyY, int bombCooldown, int attackCooldown,
+                      int turn, CellAt cellAt){
+    PlayerMove move {Direction::UP, -1, -1, -1, -1};
+    for(int i = 0; i < 4; i++){
+        Direction dir = directions[static_cast<std::size_t>((turn + i) % 4)];
+        int newX = x + (dir == Direction::RIGHT) - (dir == Direction::LEFT);
+        int newY = y + (dir == Direction::DOWN) - (dir == Direction::UP);
+        if(Game::isValidPosition(newX, newY) && cellAt(newX, newY) == '.'){
+            move.dir = dir;
+            break;
+        }
+    }
+    if(bombCooldown == 0){
+        move.bombX = x;
+        move.bombY = y;
+    }
+    if(attackCooldown == 0 && std::abs(x - enemyX) + std::abs(y - enemyY) <= ATTACK_RANGE){
+        move.attackX = enemyX;
+        move.attackY = enemyY;
+    }
+    return move;
+}
+
+PlayerMove chooseMove(const Game& game, int player){
+    return chooseMove(game.getX(player), game.getY(player), game.getX(1 - player), game.getY(1 - player),
+                      game.getBombCooldown(player), game.getAttackCooldown(player), game.getCurrentTurn(),
+                      [&game](int x, int y){ return game.getCell(x, y); });
+}
+
+PlayerMove chooseMove(const BatchGame& batch, int game, int player){
+    return chooseMove(batch.getX(game, player), batch.getY(game, player),
+                      batch.getX(game, 1 - player), batch.getY(game, 1 - player),
+                      batch.getBombCooldown(game, player), batch.getAttackCooldown(game, player),
+                      batch.getCurrentTurn(game),
+                      [&batch, game](int x, int y){ return batch.getCell(game, x, y); });
+}
+
+std::string moveString(const PlayerMove& move){
+    return "MOVE " + std::string(directionName(move.dir)) +
+           " BOMB " + std::to_string(move.bombX) + " " + std::to_string(move.bombY) +
+           " ATTACK " + std::to_string(move.attackX) + " " + std::to_string(move.attackY);
+}
+
+using Clock = std::chrono::steady_clock;
+
+void report(const char* name, long long steps, Clock::duration elapsed){
+    std::chrono::duration<double> seconds = elapsed;
+    std::cout << name << ": " << steps << " game-steps, "
+    << static_cast<double>(steps) / seconds.count() << " game-steps/s\n";
+}
+
+void runEngines(const std::vector<unsigned>& seeds){
+    std::vector<std::unique_ptr<Engine>> engines;
+    for(unsigned seed : seeds){
+        engines.push_back(std::make_unique<Engine>("/dev/null", seed));
+    }
+
+    long long steps = 0;
+    Clock::duration elapsed {};
+    for(int turn = 0; turn < MAX_TURNS; turn++){
+        for(std::unique_ptr<Engine>& engine : engines){
+            if(engine->isGameOver()) continue;
+            std::string move1 = moveString(chooseMove(engine->getGame(), 0));
+            std::string move2 = moveString(chooseMove(engine->getGame(), 1));
+
+            auto start = Clock::now();
+            engine->processTurn({move1, move2});
+            elapsed += Clock::now() - start;
+            steps++;
+        }
+    }
+    report("Engine loop", steps, elapsed);
+}
+
+void runGames(const std::vector<unsigned>& seeds){
+    std::vector<Game> games;
+    games.reserve(seeds.size());
+    for(unsigned seed : seeds){
+        games.emplace_back(seed);
+    }
+
+    std::vector<PlayerMove> moves1(seeds.size()), moves2(seeds.size());
+    long long steps = 0;
+    Clock::duration elapsed {};
+    for(int turn = 0; turn < MAX_TURNS; turn++){
+        for(std::size_t i = 0; i < games.size(); i++){
+            moves1[i] = chooseMove(games[i], 0);
+            moves2[i] = chooseMove(games[i], 1);
+        }
+
+        auto start = Clock::now();
+        for(std::size_t i = 0; i < games.size(); i++){
+            if(games[i].isGameOver()) continue;
+            games[i].playTurn({moves1[i], moves2[i]});
+            steps++;
+        }
+        elapsed += Clock::now() - start;
+    }
+    report("Game loop  ", steps, elapsed);
+}
+
+void runBatch(const std::vector<unsigned>& seeds){
+    BatchGame batch(seeds);
+
+    std::vector<PlayerMove> moves1(seeds.size()), moves2(seeds.size());
+    long long steps = 0;
+    Clock::duration elapsed {};
+    for(int turn = 0; turn < MAX_TURNS; turn++){
+        for(int game = 0; game < batch.size(); game++){
+            moves1[static_cast<std::size_t>(game)] = chooseMove(batch, game, 0);
+            moves2[static_cast<std::size_t>(game)] = chooseMove(batch, game, 1);
+            steps += !batch.isGameOver(game);
+        }
+
+        auto start = Clock::now();
+        batch.step(moves1, moves2);
+        elapsed += Clock::now() - start;
+    }
+    report("BatchGame  ", steps, elapsed);
+}
+
+} // namespace
+
+int main(){
+    std::vector<unsigned> seeds;
+    for(unsigned seed = 1; seed <= 500; seed++){
+        seeds.push_back(seed);
+    }
+
+    runEngines(seeds);
+    runGames(seeds);
+    runBatch(seeds);
+    return 0;
+}
@@ -0,0 +1,97 @@
+//Micro-benchmark of Engine::parseMove against the previous std::stringstream based parser.
+//Build and run with: make bench && ./bench/bin/parse_move_bench
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "../include/engine.h"
+
+namespace {
+
+std::size_t allocations = 0;
+
+//The parser as it was before it was rewritten over std::string_view/std::from_chars
+bool legacyParseMove(const std::string_view input, PlayerMove& move){
+    std::stringstream ss(input.data());
+
+    std::string moveStr, dirStr, attackStr, bombStr;
+
+    if(!(ss >> moveStr) || moveStr != "MOVE"){
+        return false;
+    }
+    if(!(ss >> dirStr) ||
+    (dirStr != "UP" && dirStr != "DOWN" && dirStr != "LEFT" && dirStr != "RIGHT")){
+        return false;
+    }
+    if(!(ss >> bombStr) || bombStr != "BOMB"){
+        return false;
+    }
+    if(!(ss >> move.bombX) || !(ss >> move.bombY)){
+        return false;
+    }
+    if(!(ss >> attackStr) || attackStr != "ATTACK"){
+        return false;
+    }
+    if(!(ss >> move.attackX) || !(ss >> move.attackY)){
+        return false;
+    }
+    std::string remaining;
+    if(ss >> remaining){
+        return false; //Extra input
+    }
+    return true;
+}
+
+template <typename Parser>
+void run(const char* name, Parser parse, const std::array<std::string, 4>& inputs, int iterations){
+    PlayerMove move;
+    int valid = 0;
+
+    std::size_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; ++i){
+        valid += parse(inputs[static_cast<std::size_t>(i) % inputs.size()], move);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t allocated = allocations - allocationsBefore;
+
+    std::cout << name << ": " << elapsed.count() / iterations << " ns/parse, "
+    << static_cast<double>(allocated) / iterations << " allocations/parse ("
+    << valid << " valid)\n";
+}
+
+} // namespace
+
+void* operator new(std::size_t size){
+    allocations++;
+    if(void* p = std::malloc(size)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept{
+    std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept{
+    std::free(p);
+}
+
+int main(){
+    const std::array<std::string, 4> inputs {
+        "MOVE UP BOMB -1 -1 ATTACK -1 -1",
+        "MOVE LEFT BOMB 3 4 ATTACK 5 6",
+        "MOVE RIGHT BOMB 12 19 ATTACK -1 -1",
+        "MOVE DOWN BOMB -1 -1 ATTACK 11 13"
+    };
+    constexpr int iterations = 2'000'000;
+
+    run("stringstream parser", legacyParseMove, inputs, iterations);
+    run("string_view parser ", Engine::parseMove, inputs, iterations);
+    return 0;
+}
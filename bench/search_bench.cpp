@@ -0,0 +1,92 @@
+//Micro-benchmark of a small exhaustive search over the rules, undoing turns with
+//Game::makeTurn/unmakeTurn against copying the whole Game at every node.
+//Build and run with: make bench && ./bench/bin/search_bench
+
+#include <iostream>
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "../include/game.h"
+
+namespace {
+
+constexpr std::array<Direction, 4> directions {
+    Direction::UP, Direction::DOWN, Direction::LEFT, Direction::RIGHT
+};
+
+//Moves of `player` tried at every node: each direction, with a bomb on its cell
+//when the bomb cooldown is over and an attack on the enemy when it is in range
+std::vector<PlayerMove> candidateMoves(const Game& game, int player){
+    std::vector<PlayerMove> moves;
+    int x = game.getX(player), y = game.getY(player);
+    int enemyX = game.getX(1 - player), enemyY = game.getY(1 - player);
+    bool canBomb = game.getBombCooldown(player) == 0;
+    bool canAttack = game.getAttackCooldown(player) == 0 &&
+        std::abs(x - enemyX) + std::abs(y - enemyY) <= ATTACK_RANGE;
+
+    for(Direction dir : directions){
+        moves.emplace_back(dir, -1, -1, -1, -1);
+        if(canBomb) moves.emplace_back(dir, x, y, -1, -1);
+        if(canAttack) moves.emplace_back(dir, -1, -1, enemyX, enemyY);
+    }
+    return moves;
+}
+
+long long searchMakeUnmake(Game& game, int depth){
+    long long nodes = 1;
+    if(depth == 0 || game.isGameOver()) return nodes;
+
+    std::vector<PlayerMove> moves1 = candidateMoves(game, 0);
+    std::vector<PlayerMove> moves2 = candidateMoves(game, 1);
+    for(const PlayerMove& move1 : moves1){
+        for(const PlayerMove& move2 : moves2){
+            GameState undo = game.makeTurn({move1, move2});
+            nodes += searchMakeUnmake(game, depth - 1);
+            game.unmakeTurn(undo);
+        }
+    }
+    return nodes;
+}
+
+long long searchCopy(const Game& game, int depth){
+    long long nodes = 1;
+    if(depth == 0 || game.isGameOver()) return nodes;
+
+    std::vector<PlayerMove> moves1 = candidateMoves(game, 0);
+    std::vector<PlayerMove> moves2 = candidateMoves(game, 1);
+    for(const PlayerMove& move1 : moves1){
+        for(const PlayerMove& move2 : moves2){
+            Game child = game;
+            child.playTurn({move1, move2});
+            nodes += searchCopy(child, depth - 1);
+        }
+    }
+    return nodes;
+}
+
+template <typename Search>
+void run(const char* name, Search search){
+    long long nodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(unsigned seed = 1; seed <= 5; ++seed){
+        Game game(seed);
+        nodes += search(game);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << nodes << " nodes, "
+    << static_cast<double>(nodes) / elapsed.count() << " nodes/s\n";
+}
+
+} // namespace
+
+int main(){
+    constexpr int depth = 3;
+
+    std::cout << "Game is " << sizeof(Game) << " bytes, GameState is " << sizeof(GameState) << " bytes\n";
+    run("copy Game      ", [](Game& game){ return searchCopy(game, depth); });
+    run("make/unmakeTurn", [](Game& game){ return searchMakeUnmake(game, depth); });
+    return 0;
+}
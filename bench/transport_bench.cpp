@@ -0,0 +1,146 @@
+//Micro-benchmark of the round trip between the engine and a bot over pipes and over shared memory.
+//The engine side is the engine's own code (writePipe() and readPipesDeadline(), ShmChannel and
+//readChannelsDeadline()), and a forked echo process stands for the bot: it is sent an observation
+//frame and answers with a move frame, as with protocol versions 3 and 4.
+//Build and run with: make bench && ./bench/bin/transport_bench
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/util.h"
+#include "../include/shm_ring.h"
+#include "../include/shm_channel.h"
+
+namespace {
+
+constexpr std::uint32_t OBSERVATION_SIZE = 4 + 10 * 4 + 3 * 4 * 2; //A turn that changed two cells
+constexpr std::uint32_t MOVE_SIZE = 4 + 5 * 4;
+constexpr std::chrono::milliseconds DEADLINE {1000};
+
+//A frame of `size` bytes, its length included
+std::string makeFrame(std::uint32_t size){
+    std::string frame(size, '\0');
+    std::uint32_t length = size - 4;
+    std::copy_n(reinterpret_cast<char*>(&length), 4, frame.data());
+    return frame;
+}
+
+bool readAll(int fd, char* data, std::size_t size){
+    while(size > 0){
+        ssize_t n = ::read(fd, data, size);
+        if(n <= 0){
+            return false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+//Prints the median, 99th percentile and mean of the round trips
+void report(const char* name, std::vector<double>& roundTrips){
+    std::sort(roundTrips.begin(), roundTrips.end());
+    double total = 0;
+    for(double t : roundTrips){
+        total += t;
+    }
+    std::cout << name << ": median " << roundTrips[roundTrips.size() / 2] << " us, p99 "
+    << roundTrips[roundTrips.size() * 99 / 100] << " us, mean " << total / static_cast<double>(roundTrips.size())
+    << " us (" << roundTrips.size() << " round trips)\n";
+}
+
+std::vector<double> pipeRoundTrips(int iterations){
+    asio::io_context ctx;
+    bp::pipe toBot;
+    bp::async_pipe toEngine(ctx);
+    std::string observation = makeFrame(OBSERVATION_SIZE), move = makeFrame(MOVE_SIZE);
+
+    pid_t bot = fork();
+    if(bot == 0){
+        ::close(toBot.native_sink());
+        ::close(toEngine.native_source());
+        char frame[OBSERVATION_SIZE];
+        while(readAll(toBot.native_source(), frame, sizeof(frame))){
+            if(::write(toEngine.native_sink(), move.data(), move.size()) != static_cast<ssize_t>(move.size())){
+                break;
+            }
+        }
+        std::_Exit(0);
+    }
+
+    std::vector<double> roundTrips;
+    std::vector<bp::async_pipe*> pipes {&toEngine};
+    for(int i = 0; i < iterations; ++i){
+        auto start = std::chrono::steady_clock::now();
+        if(writePipe(toBot, observation) == -1 ||
+           !readPipesDeadline(pipes, ctx, start, DEADLINE, {true})[0].line){
+            break;
+        }
+        roundTrips.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    toBot.close();
+    waitpid(bot, nullptr, 0);
+    return roundTrips;
+}
+
+std::vector<double> shmRoundTrips(int iterations){
+    ShmChannel channel;
+    std::string observation = makeFrame(OBSERVATION_SIZE), move = makeFrame(MOVE_SIZE);
+
+    pid_t bot = fork();
+    if(bot == 0){
+        //The memory is opened by name, as a bot does
+        int fd = shm_open(channel.getName().c_str(), O_RDWR, 0);
+        void* memory = fd == -1 ? MAP_FAILED : mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(memory == MAP_FAILED){
+            perror("shm_open");
+            std::_Exit(2);
+        }
+        ShmSegment* segment = static_cast<ShmSegment*>(memory);
+        char payload[OBSERVATION_SIZE];
+        for(int i = 0; i < iterations; ++i){
+            shmWait(segment->toBot, -1);
+            std::int64_t length = shmFrontLength(segment->toBot, sizeof(payload));
+            if(length < 0){
+                break;
+            }
+            shmPop(segment->toBot, payload, static_cast<std::uint32_t>(length));
+            shmPush(segment->toEngine, move.data(), static_cast<std::uint32_t>(move.size()));
+        }
+        std::_Exit(0);
+    }
+
+    std::vector<double> roundTrips;
+    std::vector<ShmChannel*> channels {&channel};
+    for(int i = 0; i < iterations; ++i){
+        auto start = std::chrono::steady_clock::now();
+        if(!channel.send(observation) || !readChannelsDeadline(channels, start, DEADLINE)[0].line){
+            break;
+        }
+        roundTrips.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    waitpid(bot, nullptr, 0);
+    return roundTrips;
+}
+
+} // namespace
+
+int main(){
+    constexpr int iterations = 200'000;
+
+    std::vector<double> pipes = pipeRoundTrips(iterations);
+    report("pipes        ", pipes);
+    std::vector<double> sharedMemory = shmRoundTrips(iterations);
+    report("shared memory", sharedMemory);
+    return 0;
+}
@@ -0,0 +1,222 @@
+#ifndef bot_sdk_h
+#define bot_sdk_h
+
+//Everything a bot needs to talk to the engine with protocol version 3 (see Game_Description.md):
+//the first turn is read and answered as text, then observations and moves are binary frames,
+//so reading a turn is a few fixed-offset reads instead of parsing lines of text.
+//It also asks for MULTIGAME, so the same process can be given one game after another.
+//A bot the engine offers shared memory (--shm-bots) asks for version 4 instead, the same frames
+//then go through the shared memory (see include/shm_ring.h) rather than the pipes.
+//It only uses the standard library so it can be included by a bot that is a single .cpp file.
+//The engine only hashes the bot's source to cache its build, touch the bot after changing this file.
+
+#include "../include/shm_ring.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+namespace botsdk{
+
+enum class Direction { NONE, UP, DOWN, LEFT, RIGHT }; //Same values as the engine's
+
+struct Move{
+    Direction dir {Direction::NONE};
+    int bombX {-1}, bombY {-1}; //-1 -1 to place no bomb
+    int attackX {-1}, attackY {-1}; //-1 -1 to not attack
+};
+
+struct Observation{
+    bool firstTurn {true}; //First turn of a game, a bot keeping state between turns starts over
+    int gridSize {};
+    Direction enemyMove {Direction::NONE}; //NONE on the first turn
+    int x {}, y {};
+    int bombCooldown {}, attackCooldown {};
+    int crystals {}, enemyCrystals {};
+    int hp {}, enemyHP {};
+    std::vector<std::string> grid; //grid[y][x] is '#', 'C' or '.', kept up to date from the changes
+
+    bool isValidPosition(int cellX, int cellY) const{
+        return cellX >= 0 && cellX < gridSize && cellY >= 0 && cellY < gridSize;
+    }
+};
+
+//The bot's end of the pipes, stdin and stdout
+class Connection{
+private:
+    bool firstTurn {true};
+    std::vector<std::int32_t> frame;
+    ShmSegment* segment {nullptr}; //The shared memory offered by the engine, if any
+    pid_t engine {getppid()};
+
+    //Maps the shared memory named in the environment, if there is one
+    static ShmSegment* openSharedMemory(){
+        const char* name = std::getenv(SHM_ENV);
+        if(name == nullptr){
+            return nullptr;
+        }
+        int fd = shm_open(name, O_RDWR, 0);
+        if(fd == -1){
+            return nullptr;
+        }
+        void* memory = mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        return memory == MAP_FAILED ? nullptr : static_cast<ShmSegment*>(memory);
+    }
+
+    static bool readWord(std::string& word){
+        word.clear();
+        int c = std::getchar();
+        while(c == ' ' || c == '\n' || c == '\r'){
+            c = std::getchar();
+        }
+        while(c != EOF && c != ' ' && c != '\n' && c != '\r'){
+            word += static_cast<char>(c);
+            c = std::getchar();
+        }
+        std::ungetc(c, stdin); //Left for the end of the line to be found
+        return !word.empty();
+    }
+
+    static bool readInt(int& value){
+        return std::scanf("%d", &value) == 1;
+    }
+
+    //Reads the cells "x y" listed after "OBSTACLES n" or "CRYSTALS n"
+    static bool readCells(Observation& obs, char cell){
+        int count, cellX, cellY;
+        if(!readInt(count)) return false;
+        for(int i = 0; i < count; ++i){
+            if(!readInt(cellX) || !readInt(cellY)) return false;
+            obs.grid[static_cast<std::size_t>(cellY)][static_cast<std::size_t>(cellX)] = cell;
+        }
+        return true;
+    }
+
+    //The first turn: "GRID n" (after "NEWGAME" if it is not the first game), the game state,
+    //then the rows of the grid or (on large maps) the lists of obstacles and crystals
+    static bool readFirstTurn(Observation& obs){
+        std::string word;
+        if(!readWord(word)) return false;
+        if(word == "NEWGAME" && !readWord(word)) return false;
+        if(!readInt(obs.gridSize)) return false;
+        if(!readInt(obs.x) || !readInt(obs.y) || !readInt(obs.bombCooldown) || !readInt(obs.attackCooldown)
+           || !readInt(obs.crystals) || !readInt(obs.enemyCrystals) || !readInt(obs.hp) || !readInt(obs.enemyHP)){
+            return false;
+        }
+        std::size_t size = static_cast<std::size_t>(obs.gridSize);
+        obs.grid.assign(size, std::string(size, '.'));
+        if(!readWord(word)) return false;
+        if(word == "OBSTACLES"){
+            if(!readCells(obs, '#') || !readWord(word) || !readCells(obs, 'C')) return false;
+        }
+        else{
+            obs.grid[0] = word;
+            for(std::size_t row = 1; row < size; ++row){
+                if(!readWord(obs.grid[row])) return false;
+            }
+        }
+        //The frames start right after the end of this line
+        int c = std::getchar();
+        while(c != '\n' && c != EOF){
+            c = std::getchar();
+        }
+        return true;
+    }
+
+    //Reads the next frame into `frame`, without its length
+    bool readFrame(){
+        std::uint32_t length;
+        if(segment){
+            //Unlike a pipe the memory is not closed if the engine exits, check for it every second
+            while(!shmWait(segment->toBot, shmNow() + 1'000'000'000)){
+                if(getppid() != engine) return false;
+            }
+            std::int64_t front = shmFrontLength(segment->toBot, ShmRing::MAX_PAYLOAD);
+            if(front < 0 || front % sizeof(std::int32_t) != 0) return false;
+            length = static_cast<std::uint32_t>(front);
+            frame.resize(length / sizeof(std::int32_t));
+            shmPop(segment->toBot, reinterpret_cast<char*>(frame.data()), length);
+            return true;
+        }
+        if(std::fread(&length, sizeof(length), 1, stdin) != 1 || length % sizeof(std::int32_t) != 0) return false;
+        frame.resize(length / sizeof(std::int32_t));
+        return std::fread(frame.data(), 1, length, stdin) == length;
+    }
+
+    void writeFrame(const Move& move){
+        const std::int32_t values[] = {static_cast<std::int32_t>(5 * sizeof(std::int32_t)), static_cast<std::int32_t>(move.dir),
+                                       move.bombX, move.bombY, move.attackX, move.attackY};
+        if(segment){
+            shmPush(segment->toEngine, reinterpret_cast<const char*>(values), sizeof(values));
+            return;
+        }
+        std::fwrite(values, sizeof(values), 1, stdout);
+        std::fflush(stdout);
+    }
+
+public:
+    Connection() : segment(openSharedMemory()) {}
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    ~Connection(){
+        if(segment){
+            munmap(segment, sizeof(ShmSegment));
+        }
+    }
+
+    //Reads the next observation into `obs` (the same one every turn, the grid is updated in place).
+    //Returns false once the engine has closed the pipe.
+    bool read(Observation& obs){
+        obs.firstTurn = firstTurn;
+        if(firstTurn){
+            obs.enemyMove = Direction::NONE;
+            return readFirstTurn(obs);
+        }
+        if(!readFrame()) return false;
+        if(frame.empty()){
+            //The game is over and a new one starts, as text
+            firstTurn = true;
+            return read(obs);
+        }
+        if(frame.size() < 10) return false;
+
+        obs.enemyMove = static_cast<Direction>(frame[0]);
+        obs.x = frame[1];
+        obs.y = frame[2];
+        obs.bombCooldown = frame[3];
+        obs.attackCooldown = frame[4];
+        obs.crystals = frame[5];
+        obs.enemyCrystals = frame[6];
+        obs.hp = frame[7];
+        obs.enemyHP = frame[8];
+        std::size_t changes = static_cast<std::size_t>(frame[9]);
+        if(frame.size() != 10 + 3 * changes) return false;
+        for(std::size_t i = 10; i < frame.size(); i += 3){
+            obs.grid[static_cast<std::size_t>(frame[i + 1])][static_cast<std::size_t>(frame[i])] =
+                static_cast<char>(frame[i + 2]);
+        }
+        return true;
+    }
+
+    //Sends the move for this turn, asking for MULTIGAME and protocol version 3 (4 with shared memory)
+    //with the first one of a game
+    void send(const Move& move){
+        if(!firstTurn){
+            writeFrame(move);
+            return;
+        }
+        static constexpr const char* NAMES[] = {"", "UP", "DOWN", "LEFT", "RIGHT"};
+        std::printf("MOVE %s BOMB %d %d ATTACK %d %d MULTIGAME PROTOCOL %d\n", NAMES[static_cast<int>(move.dir)],
+                    move.bombX, move.bombY, move.attackX, move.attackY, segment ? 4 : 3);
+        std::fflush(stdout);
+        firstTurn = false;
+    }
+};
+
+} //namespace botsdk
+#endif //bot_sdk_h
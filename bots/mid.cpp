@@ -1,29 +1,61 @@
 #include <iostream>
 #include <string>
 #include <random>
-#include <array>
+#include <vector>
 #include <cstddef>
 
-constexpr int GRID_SIZE = 20;
+int gridSize = 20; //Sent on the first turn ("GRID 20")
 
 bool isValidPosition(int x, int y){
-    return x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE;
+    return x >= 0 && x < gridSize && y >= 0 && y < gridSize;
+}
+
+//Reads the grid sent after the game state. Large maps are sent as lists of cells instead of rows:
+//the obstacles and crystals on the first turn, then only the cells that changed.
+void readGrid(std::vector<std::string>& grid){
+    std::string word;
+    std::cin >> word;
+    if(word == "OBSTACLES"){
+        int count, cellX, cellY;
+        std::cin >> count;
+        for(int i = 0; i < count; ++i){
+            std::cin >> cellX >> cellY;
+            grid[cellY][cellX] = '#';
+        }
+        std::cin >> word >> count; //"CRYSTALS"
+        for(int i = 0; i < count; ++i){
+            std::cin >> cellX >> cellY;
+            grid[cellY][cellX] = 'C';
+        }
+    }
+    else if(word == "CHANGES"){
+        int count, cellX, cellY;
+        std::cin >> count;
+        for(int i = 0; i < count; ++i){
+            std::cin >> cellX >> cellY;
+            std::cin >> grid[cellY][cellX];
+        }
+    }
+    else{
+        grid[0] = word;
+        for(int i = 1; i < gridSize; ++i){
+            std::cin >> grid[i];
+        }
+    }
 }
 
 int main(){
     int x, y, ignore;
+    std::string gridWord;
+    std::cin >> gridWord >> gridSize; //Read the grid size
     std::cin >> x >> y; //Read our position
     for (int i = 0; i < 6; i++)
     {
         int ignore;
         std::cin >> ignore;
     }
-    std::array<std::array<char, GRID_SIZE>, GRID_SIZE> grid;
-    for(int i = 0; i < GRID_SIZE; ++i){
-        for(int j = 0; j < GRID_SIZE; ++j){
-            std::cin >> grid[i][j];
-        }
-    }
+    std::vector<std::string> grid(gridSize, std::string(gridSize, '.'));
+    readGrid(grid);
 
     std::string dirs[4] = {"UP", "DOWN", "LEFT", "RIGHT"};
     std::random_device rd;
@@ -51,7 +83,8 @@ int main(){
         }
     }
 
-    std::cout << "MOVE " << dirs[ind] << " BOMB -1 -1 ATTACK -1 -1" << std::endl;
+    //Ask for protocol version 2: from now on only the cells that change are sent
+    std::cout << "MOVE " << dirs[ind] << " BOMB -1 -1 ATTACK -1 -1 PROTOCOL 2" << std::endl;
 
     while(true){
         std::string oppDir;
@@ -63,11 +96,7 @@ int main(){
             std::cin >> ignore;
         }
 
-        for(int i = 0; i < GRID_SIZE; ++i){
-            for(int j = 0; j < GRID_SIZE; ++j){
-                std::cin >> grid[i][j];
-            }
-        }
+        readGrid(grid);
         
         ind = dis(gen);
         newX = x;
@@ -0,0 +1,53 @@
+#include "../include/bot_plugin.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+//Same moves as mid.cpp, built as a plugin the engine calls directly (--plugin-bots)
+
+namespace {
+
+//Everything the bot keeps during a game
+struct Bot{
+    std::mt19937 gen {std::random_device{}()};
+    int gridSize {};
+    std::vector<std::string> grid; //grid[y][x] is '#', 'C' or '.'
+};
+
+} // namespace
+
+extern "C" void* bot_init(void){
+    return new Bot;
+}
+
+extern "C" void bot_act(void* state, const BotObservation* obs, BotMove* move){
+    Bot& bot = *static_cast<Bot*>(state);
+    if(obs->grid){
+        bot.gridSize = obs->gridSize;
+        bot.grid.clear();
+        for(int y = 0; y < obs->gridSize; ++y){
+            bot.grid.emplace_back(obs->grid + y * obs->gridSize, static_cast<std::size_t>(obs->gridSize));
+        }
+    }
+    for(int i = 0; i < obs->changeCount; ++i){
+        const int32_t* change = obs->changes + 3 * i;
+        bot.grid[static_cast<std::size_t>(change[1])][static_cast<std::size_t>(change[0])] = static_cast<char>(change[2]);
+    }
+
+    const int dx[4] = {0, 0, -1, 1};
+    const int dy[4] = {-1, 1, 0, 0};
+    std::vector<int> free;
+    for(int d = 0; d < 4; ++d){
+        int newX = obs->x + dx[d], newY = obs->y + dy[d];
+        if(newX >= 0 && newX < bot.gridSize && newY >= 0 && newY < bot.gridSize &&
+           bot.grid[static_cast<std::size_t>(newY)][static_cast<std::size_t>(newX)] == '.'){
+            free.push_back(d);
+        }
+    }
+    move->dir = free.empty() ? 1 : free[bot.gen() % free.size()] + 1;
+}
+
+extern "C" void bot_free(void* state){
+    delete static_cast<Bot*>(state);
+}
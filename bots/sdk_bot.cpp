@@ -0,0 +1,31 @@
+#include "bot_sdk.h"
+
+#include <random>
+#include <vector>
+
+//Same moves as mid.cpp, written with bot_sdk.h (protocol version 3)
+int main(){
+    botsdk::Connection connection;
+    botsdk::Observation obs;
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    const botsdk::Direction dirs[4] = {botsdk::Direction::UP, botsdk::Direction::DOWN,
+                                       botsdk::Direction::LEFT, botsdk::Direction::RIGHT};
+    const int dx[4] = {0, 0, -1, 1};
+    const int dy[4] = {-1, 1, 0, 0};
+
+    while(connection.read(obs)){
+        std::vector<int> free;
+        for(int d = 0; d < 4; ++d){
+            int newX = obs.x + dx[d], newY = obs.y + dy[d];
+            if(obs.isValidPosition(newX, newY) && obs.grid[newY][newX] == '.'){
+                free.push_back(d);
+            }
+        }
+        botsdk::Move move;
+        move.dir = free.empty() ? botsdk::Direction::UP : dirs[free[gen() % free.size()]];
+        connection.send(move);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef batch_game_h
+#define batch_game_h
+
+#include "../include/game.h"
+#include "../include/bitboard.h"
+#include "../include/move.h"
+
+#include <array>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+//Many independent games played in lockstep, e.g. to generate self-play data.
+//Each field is stored for all games in its own array (struct of arrays), indexed by game,
+//and step() runs every phase of the turn over all games at once so the compiler can vectorise it.
+//The rules are the same as Game's, a game started from the same seed plays out identically.
+//No explosion table is kept (it is 22 KB per map), explosions are computed when a bomb is placed.
+//Only two-player games of the standard rules are batched, free-for-alls and larger grids are played with Game.
+class BatchGame{
+private:
+    static constexpr int PLAYERS = 2;
+
+    int count;
+
+    //Per game
+    std::vector<Bitboard<GRID_SIZE>> crystals;
+    std::vector<Bitboard<GRID_SIZE>> obstacles;
+    std::vector<int> totalCrystals;
+    std::vector<int> currentTurn;
+    std::vector<std::uint8_t> gameOver;
+    std::vector<EndReason> endReason;
+
+    //Per player, per game
+    std::array<std::vector<int>, PLAYERS> x, y;
+    std::array<std::vector<int>, PLAYERS> hp;
+    std::array<std::vector<int>, PLAYERS> crystalCount;
+    std::array<std::vector<int>, PLAYERS> bombCooldown;
+    std::array<std::vector<int>, PLAYERS> attackCooldown;
+    std::array<std::vector<Direction>, PLAYERS> lastMove;
+
+    //Results of the validation phase of step(), reused between steps
+    std::array<std::vector<std::uint8_t>, PLAYERS> valid;
+    std::array<std::vector<std::uint8_t>, PLAYERS> bombed;
+    std::array<std::vector<std::uint8_t>, PLAYERS> attacked;
+
+    bool isEmptyCell(int game, int cellX, int cellY) const;
+
+public:
+    //Starts game i from seeds[i], with the same map Game(seeds[i]) would generate
+    explicit BatchGame(const std::vector<unsigned>& seeds);
+
+    //Replaces game `game` (e.g. once it is over) with a new game started from `seed`
+    void resetGame(int game, unsigned seed);
+
+    //Plays one turn of every game that is not over. Move i of each span is for game i.
+    void step(std::span<const PlayerMove> player1Moves, std::span<const PlayerMove> player2Moves);
+
+    //Getter functions, `player` is 0 for Player 1 and 1 for Player 2
+    int size() const;
+    char getCell(int game, int cellX, int cellY) const; //'#', 'C' or '.'
+    int getTotalCrystals(int game) const;
+    bool isGameOver(int game) const;
+    int getCurrentTurn(int game) const;
+    int getX(int game, int player) const;
+    int getY(int game, int player) const;
+    int getHP(int game, int player) const;
+    int getCrystals(int game, int player) const;
+    int getBombCooldown(int game, int player) const;
+    int getAttackCooldown(int game, int player) const;
+    Direction getLastMove(int game, int player) const;
+
+    //Returns 0 if Player 1 won, 1 if Player 2 won and -1 for a tie or an ongoing game
+    int getWinner(int game) const;
+    EndReason getEndReason(int game) const;
+};
+#endif //batch_game_h
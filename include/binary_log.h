@@ -0,0 +1,76 @@
+#ifndef binary_log_h
+#define binary_log_h
+
+#include "../include/log_writer.h"
+
+#include <string>
+#include <fstream>
+#include <istream>
+#include <cstdint>
+
+//Compact binary game log, a few dozen bytes per turn instead of kilobytes of JSON.
+//
+//File layout (all integers are LEB128 varints, signed ones zigzag encoded first):
+//  "CGLB" version(1 byte)
+//  'G' gridSize players obstacleBitmap crystalBitmap marker1 ... markerN (N = players)
+//      Bitmaps hold gridSize * gridSize bits in row-major order, least significant bit first.
+//      markerN is 1 + the cell index (y * gridSize + x) where player N is drawn, or 0.
+//  'T' turn, then for each player:
+//      flags(1 byte: bit 0 read error, bits 1-3 direction, bit 4 eliminated)
+//      bombX bombY attackX attackY (signed)
+//      x y hp crystals (signed deltas from the previous turn)
+//      attackCooldown bombCooldown responseTimeMicroseconds cpuTimeMicroseconds writeSyscalls(signed)
+//      and then gameOver(1 byte), if set followed by winner(signed) endReasonLength endReason
+//  'F' once the game is over
+//A log cut short by a crash is still readable up to its last complete turn.
+//Version 1 logs (two players, no `players` in 'G') and version 2 logs (no cpuTimeMicroseconds) are still read.
+class BinaryLogWriter : public LogWriter{
+private:
+    std::string path;
+    std::ofstream file;
+    std::string buffer; //Encoded entry, reused between turns
+    TurnRecord previous; //For delta encoding
+    bool finished {false};
+
+    void open();
+    void flushBuffer();
+
+public:
+    //The file is only created when the first entry is written
+    explicit BinaryLogWriter(std::string path);
+    ~BinaryLogWriter() override;
+
+    void writeGrid(const std::string& grid, int players) override;
+    void writeTurn(const TurnRecord& turn) override;
+    void finish() override;
+};
+
+//Reads back a log written by BinaryLogWriter
+class BinaryLogReader{
+private:
+    std::istream& in;
+    TurnRecord previous; //For delta decoding
+    bool valid {false};
+    char version {};
+    int players {2};
+
+    bool readVarint(std::uint64_t& value);
+    bool readSigned(int& value);
+    bool readUnsigned(int& value);
+
+public:
+    explicit BinaryLogReader(std::istream& input);
+
+    //False if the input does not start with the binary log header
+    bool isValid() const;
+
+    //Number of players, known once the grid has been read
+    int getPlayerCount() const;
+
+    enum class Entry { GRID, TURN, END };
+
+    //Reads the next entry into `grid` or `turn`.
+    //Returns END at the end of the log, including when the log is truncated.
+    Entry next(std::string& grid, TurnRecord& turn);
+};
+#endif //binary_log_h
@@ -0,0 +1,81 @@
+#ifndef bitboard_h
+#define bitboard_h
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+//Set of cells of a `Size` x `Size` grid, one bit per cell (cell (x, y) is bit y * Size + x).
+//Whole-board queries like "which crystals does this explosion cover" become
+//a few word-wise AND/OR operations and a popcount.
+template <int Size>
+class Bitboard{
+public:
+    static constexpr int CELLS = Size * Size;
+    static constexpr int WORDS = (CELLS + 63) / 64;
+
+    constexpr bool test(int x, int y) const{
+        int i = index(x, y);
+        return (words[word(i)] >> bit(i)) & 1;
+    }
+    constexpr void set(int x, int y){
+        int i = index(x, y);
+        words[word(i)] |= std::uint64_t{1} << bit(i);
+    }
+    constexpr void reset(int x, int y){
+        int i = index(x, y);
+        words[word(i)] &= ~(std::uint64_t{1} << bit(i));
+    }
+
+    //Number of cells in the set
+    constexpr int count() const{
+        int total = 0;
+        for(std::uint64_t w : words){
+            total += std::popcount(w);
+        }
+        return total;
+    }
+    constexpr bool any() const{
+        for(std::uint64_t w : words){
+            if(w != 0) return true;
+        }
+        return false;
+    }
+
+    //Calls f(x, y) for every cell in the set, in increasing y then x order
+    template <typename F>
+    constexpr void forEach(F&& f) const{
+        for(int w = 0; w < WORDS; ++w){
+            for(std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1){
+                int i = w * 64 + std::countr_zero(bits);
+                f(i % Size, i / Size);
+            }
+        }
+    }
+
+    constexpr Bitboard& operator&=(const Bitboard& other){
+        for(int i = 0; i < WORDS; ++i) words[i] &= other.words[i];
+        return *this;
+    }
+    constexpr Bitboard& operator|=(const Bitboard& other){
+        for(int i = 0; i < WORDS; ++i) words[i] |= other.words[i];
+        return *this;
+    }
+    //Removes every cell of `other` from this set
+    constexpr Bitboard& andNot(const Bitboard& other){
+        for(int i = 0; i < WORDS; ++i) words[i] &= ~other.words[i];
+        return *this;
+    }
+
+    friend constexpr Bitboard operator&(Bitboard a, const Bitboard& b){ return a &= b; }
+    friend constexpr Bitboard operator|(Bitboard a, const Bitboard& b){ return a |= b; }
+    friend constexpr bool operator==(const Bitboard& a, const Bitboard& b) = default;
+
+private:
+    std::array<std::uint64_t, WORDS> words {};
+
+    static constexpr int index(int x, int y){ return y * Size + x; }
+    static constexpr std::size_t word(int i){ return static_cast<std::size_t>(i / 64); }
+    static constexpr int bit(int i){ return i % 64; }
+};
+#endif //bitboard_h
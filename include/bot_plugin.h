@@ -0,0 +1,48 @@
+#ifndef bot_plugin_h
+#define bot_plugin_h
+
+/*
+The C interface of a bot built as a shared object and called by the engine from the match loop
+instead of being run as a process (see --plugin-bots in README.md). A plugin exports the three
+functions below. It runs inside the engine, so it must be trusted: a crash takes the engine down.
+The engine plays several games at once on different threads, so everything a game needs must be
+kept in the state returned by bot_init(), not in globals. The calls of a game are made on a thread
+of their own, not the one bot_init() was called on, and a call that misses the time limit is not
+waited for: the plugin is not called again for the rest of the run, and bot_free() is called when that call returns.
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BotObservation{
+    int32_t gridSize;
+    int32_t enemyMove; /* 0 on the first turn, then 1 UP, 2 DOWN, 3 LEFT, 4 RIGHT */
+    int32_t x, y;
+    int32_t bombCooldown, attackCooldown;
+    int32_t crystals, enemyCrystals;
+    int32_t hp, enemyHP;
+    const char* grid; /* First turn only: the gridSize rows of gridSize cells ('#', 'C' or '.'), NULL after */
+    int32_t changeCount; /* After the first turn: number of cells changed by the last turn */
+    const int32_t* changes; /* x, y and cell (as a char) of each of them */
+} BotObservation;
+
+typedef struct BotMove{
+    int32_t dir; /* 1 UP, 2 DOWN, 3 LEFT, 4 RIGHT */
+    int32_t bombX, bombY; /* -1 -1 to place no bomb */
+    int32_t attackX, attackY; /* -1 -1 to not attack */
+} BotMove;
+
+/* Starts a game, returns the state of the bot for it */
+void* bot_init(void);
+/* Plays a turn of the game of `bot` */
+void bot_act(void* bot, const BotObservation* observation, BotMove* move);
+/* Ends the game of `bot` */
+void bot_free(void* bot);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* bot_plugin_h */
@@ -0,0 +1,66 @@
+#ifndef bot_pool_h
+#define bot_pool_h
+
+#include <boost/process.hpp>
+#include <boost/asio.hpp>
+
+#include "../include/shm_channel.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <utility>
+
+namespace bp = boost::process;
+namespace asio = boost::asio;
+
+//A running bot and the pipes to talk to it
+struct BotProcess{
+    std::string path; //The executable
+    bp::async_pipe out; //What the bot writes
+    bp::pipe in; //What the bot reads
+    std::unique_ptr<ShmChannel> channel; //Its shared memory if it was offered some, nullptr otherwise
+    bp::child child;
+    clockid_t cpuClock; //CPU clock of the process, the time it uses to answer is measured on it
+
+    int gamesPlayed {}; //Games it finished, the next one starts with NEWGAME if it is not 0
+    bool framed {false}; //It used binary frames in its last game, NEWGAME is preceded by an empty frame
+    bool sharedMemoryFrames {false}; //These frames went through its shared memory (the empty frame too)
+
+    //Launches the executable at `path`, its output is read on `ctx`.
+    //With `sharedMemory` it is given a ShmChannel, whose name is in its environment.
+    BotProcess(const std::string& path, asio::io_context& ctx, bool sharedMemory = false);
+
+    //Kills the bot and waits for it to exit
+    void stop();
+};
+
+//Bots kept running between matches, so that a bot that can play several games in a row
+//(it asked for MULTIGAME, see Game_Description.md) is only launched once instead of once per match.
+//A bot is only put back after a game it finished cleanly, one that crashed, timed out or
+//did not ask for MULTIGAME is stopped and a fresh one is launched for its next match.
+//A pool is not thread-safe, each thread playing matches has its own.
+class BotPool{
+private:
+    asio::io_context ctx; //Every bot of the pool is read on it
+    //By executable and whether they have shared memory
+    std::map<std::pair<std::string, bool>, std::vector<std::unique_ptr<BotProcess>>> idle;
+
+public:
+    BotPool() = default;
+    BotPool(const BotPool&) = delete;
+    BotPool& operator=(const BotPool&) = delete;
+    ~BotPool(); //Stops the idle bots
+
+    //The io_context matches played with bots from this pool must use
+    asio::io_context& context();
+
+    //Returns an idle bot running `path` (with shared memory if `sharedMemory` is set)
+    //if there is one, launches a new one otherwise
+    std::unique_ptr<BotProcess> acquire(const std::string& path, bool sharedMemory = false);
+
+    //Puts `bot` back to play another game
+    void release(std::unique_ptr<BotProcess> bot);
+};
+#endif //bot_pool_h
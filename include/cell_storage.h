@@ -0,0 +1,202 @@
+#ifndef cell_storage_h
+#define cell_storage_h
+
+#include "../include/bitboard.h"
+#include "../include/chunked_grid.h"
+
+#include <array>
+#include <memory>
+#include <span>
+
+//How a game stores the cells of its map, picked by the rules (Rules::Cells, see rules.h).
+//BasicGame only uses what both classes below have:
+//  Grid                set of cells, the crystals and obstacles
+//  Area, AreaRef       cells reached by a bomb or an attack, and how a turn holds the area of a bomb
+//  obstacles           the obstacles, prepare() is called once they are placed
+//  bombArea(x, y)      area of a bomb at (x, y) on the grid, noArea() for a player without a bomb
+//  attackHits()        whether an attack (maybe aimed off the grid) reaches a cell
+//  collect()           takes the crystals in the area of a player's bomb out of the grid
+
+//Cells reached by a bomb or an attack at (x, y): up to BombRange - 1 cells in each direction,
+//stopped by `obstacles` and the edges of the grid. (x, y) may be off the grid.
+//add(x, y) is called for each cell, (x, y) first if it is on the grid.
+template <int Size, int BombRange, typename Grid, typename F>
+void forEachExplosionCell(const Grid& obstacles, int x, int y, F&& add){
+    auto onGrid = [](int cellX, int cellY){
+        return cellX >= 0 && cellX < Size && cellY >= 0 && cellY < Size;
+    };
+    if (onGrid(x, y)) {
+        add(x, y); //Add the cell where the bomb is placed
+    }
+
+    int dx[4] = {1, -1, 0, 0};
+    int dy[4] = {0, 0, 1, -1};
+
+    for (int dir = 0; dir < 4; dir++)
+    {
+        for (int dist = 1; dist <= BombRange-1; dist++)
+        {
+            int newX = x + dx[dir] * dist;
+            int newY = y + dy[dir] * dist;
+
+            if (!onGrid(newX, newY) || obstacles.test(newX, newY)) {
+                break; //Stop if out of bounds or obstacle in this direction
+            }
+            add(newX, newY);
+        }
+    }
+}
+
+//Bitboards, with the area of a bomb at every cell computed once per map:
+//a turn is a few word-wise operations, but the table grows with the grid size to the fourth power
+template <int Size, int BombRange>
+class BitboardCells{
+public:
+    using Grid = Bitboard<Size>;
+    using Area = Bitboard<Size>;
+    using AreaRef = const Area*; //Into the table, nothing is copied
+
+    Grid obstacles;
+
+    static Area computeArea(const Grid& obstacles, int x, int y){
+        Area area;
+        forEachExplosionCell<Size, BombRange>(obstacles, x, y, [&area](int cellX, int cellY){
+            area.set(cellX, cellY);
+        });
+        return area;
+    }
+
+    //Explosions only depend on the obstacles, which are now fixed
+    void prepare(){
+        auto built = std::make_shared<Table>();
+        for (int cellY = 0; cellY < Size; cellY++)
+        {
+            for (int cellX = 0; cellX < Size; cellX++)
+            {
+                (*built)[index(cellX, cellY)] = computeArea(obstacles, cellX, cellY);
+            }
+        }
+        table = std::move(built);
+    }
+
+    AreaRef bombArea(int x, int y) const{
+        return &(*table)[index(x, y)];
+    }
+    static AreaRef noArea(){
+        static const Area none;
+        return &none;
+    }
+
+    bool attackHits(int attackX, int attackY, int x, int y) const{
+        if (attackX >= 0 && attackX < Size && attackY >= 0 && attackY < Size)
+        {
+            return bombArea(attackX, attackY)->test(x, y);
+        }
+        //Attacks can be aimed off the grid (within range), they then reach the cells next to the edge
+        return computeArea(obstacles, attackX, attackY).test(x, y);
+    }
+
+    //Removes the crystals in the area of `player` from `crystals` (areas[i] is the area of player i):
+    //`collected` is the number bombed by that player only, `destroyed` of those also bombed by another one.
+    //removed(x, y) is called for each crystal removed.
+    template <typename F>
+    static void collect(Grid& crystals, std::span<const AreaRef> areas, int player,
+                        int& collected, int& destroyed, F&& removed){
+        Area otherExplosions;
+        for (std::size_t j = 0; j < areas.size(); j++)
+        {
+            if (j != static_cast<std::size_t>(player)) otherExplosions |= *areas[j];
+        }
+
+        Grid hit = crystals & *areas[static_cast<std::size_t>(player)];
+        hit.forEach(removed);
+        crystals.andNot(hit);
+
+        destroyed = (hit & otherExplosions).count();
+        collected = hit.count() - destroyed;
+    }
+
+private:
+    //The area of a bomb at (x, y) is (*table)[y * Size + x], shared by the copies of the game (it is 2 MB for a 64 x 64 grid)
+    using Table = std::array<Area, Size * Size>;
+    std::shared_ptr<const Table> table;
+
+    static std::size_t index(int x, int y){ return static_cast<std::size_t>(y * Size + x); }
+};
+
+//ChunkedGrids, with the area of a bomb computed when it is placed: a turn only touches the cells
+//around the players and their bombs, so it costs about the same whatever the size of the grid
+template <int Size, int BombRange>
+class ChunkedCells{
+public:
+    using Grid = ChunkedGrid<Size>;
+
+    //The cells as y * Size + x
+    struct Area{
+        std::array<int, 1 + 4 * (BombRange - 1)> cells {};
+        int size {};
+
+        bool test(int x, int y) const{
+            int cell = y * Size + x;
+            for (int i = 0; i < size; i++)
+            {
+                if (cells[static_cast<std::size_t>(i)] == cell) return true;
+            }
+            return false;
+        }
+        template <typename F>
+        void forEach(F&& f) const{
+            for (int i = 0; i < size; i++)
+            {
+                int cell = cells[static_cast<std::size_t>(i)];
+                f(cell % Size, cell / Size);
+            }
+        }
+    };
+    using AreaRef = Area; //A few cells, kept by value
+
+    Grid obstacles;
+
+    static Area computeArea(const Grid& obstacles, int x, int y){
+        Area area;
+        forEachExplosionCell<Size, BombRange>(obstacles, x, y, [&area](int cellX, int cellY){
+            area.cells[static_cast<std::size_t>(area.size++)] = cellY * Size + cellX;
+        });
+        return area;
+    }
+
+    void prepare(){} //Nothing is computed ahead
+
+    AreaRef bombArea(int x, int y) const{
+        return computeArea(obstacles, x, y);
+    }
+    static AreaRef noArea(){
+        return Area{};
+    }
+
+    bool attackHits(int attackX, int attackY, int x, int y) const{
+        return computeArea(obstacles, attackX, attackY).test(x, y);
+    }
+
+    //Same as BitboardCells::collect(), crystals are removed in the order of the cells of the area
+    template <typename F>
+    static void collect(Grid& crystals, std::span<const AreaRef> areas, int player,
+                        int& collected, int& destroyed, F&& removed){
+        collected = destroyed = 0;
+        areas[static_cast<std::size_t>(player)].forEach([&](int x, int y){
+            if (!crystals.test(x, y)) return;
+
+            bool shared = false;
+            for (std::size_t j = 0; j < areas.size(); j++)
+            {
+                shared = shared || (j != static_cast<std::size_t>(player) && areas[j].test(x, y));
+            }
+            if (shared) destroyed++;
+            else collected++;
+
+            crystals.reset(x, y);
+            removed(x, y);
+        });
+    }
+};
+#endif //cell_storage_h
@@ -0,0 +1,64 @@
+#ifndef chunked_grid_h
+#define chunked_grid_h
+
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+//Set of cells of a large `Size` x `Size` grid, for maps too large for a Bitboard to be copied
+//or scanned every turn. The grid is cut into 8 x 8 chunks of one 64-bit word each, so the
+//cells around a cell (e.g. an explosion) are in at most four words. Only single cells are
+//tested and changed, there are no whole-grid operations besides forEach().
+template <int Size>
+class ChunkedGrid{
+public:
+    static constexpr int CHUNK = 8; //Side of a chunk
+    static constexpr int CHUNKS_PER_ROW = (Size + CHUNK - 1) / CHUNK;
+
+    ChunkedGrid()
+    : words(static_cast<std::size_t>(CHUNKS_PER_ROW * CHUNKS_PER_ROW))
+    {
+    }
+
+    bool test(int x, int y) const{
+        return (words[word(x, y)] >> bit(x, y)) & 1;
+    }
+    void set(int x, int y){
+        words[word(x, y)] |= std::uint64_t{1} << bit(x, y);
+    }
+    void reset(int x, int y){
+        words[word(x, y)] &= ~(std::uint64_t{1} << bit(x, y));
+    }
+
+    //Number of cells in the set
+    int count() const{
+        int total = 0;
+        for(std::uint64_t w : words){
+            total += std::popcount(w);
+        }
+        return total;
+    }
+
+    //Calls f(x, y) for every cell in the set, in increasing y then x order
+    template <typename F>
+    void forEach(F&& f) const{
+        for(int y = 0; y < Size; ++y){
+            for(int chunkX = 0; chunkX < CHUNKS_PER_ROW; ++chunkX){
+                std::uint64_t row = (words[word(chunkX * CHUNK, y)] >> bit(0, y)) & 0xff;
+                for(; row != 0; row &= row - 1){
+                    f(chunkX * CHUNK + std::countr_zero(row), y);
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<std::uint64_t> words; //Chunk (x / 8, y / 8) is words[y / 8 * CHUNKS_PER_ROW + x / 8]
+
+    static std::size_t word(int x, int y){
+        return static_cast<std::size_t>(y / CHUNK * CHUNKS_PER_ROW + x / CHUNK);
+    }
+    static int bit(int x, int y){ return y % CHUNK * CHUNK + x % CHUNK; }
+};
+#endif //chunked_grid_h
@@ -2,137 +2,193 @@
 #define engine_h
 
 #include "../include/nlohmann_json.hpp"
+#include "../include/game.h"
+#include "../include/log_writer.h"
+#include "../include/move.h"
+#include "../include/bot_plugin.h"
 
 #include <iostream>
 #include <string>
 #include <string_view>
 #include <array>
-#include <random>
 #include <ctime>
 #include <vector>
 #include <utility>
-#include <set>
 #include <fstream>
+#include <chrono>
+#include <memory>
 
 using json = nlohmann::json;
 
-constexpr int GRID_SIZE = 20;
-constexpr int MAX_TURNS = 100;
-constexpr int INITIAL_HP = 5;
-constexpr int BOMB_RANGE = 3; //Including placed cell
-constexpr int ATTACK_RANGE = 3; //Including placed cell
-constexpr int BOMB_COOLDOWN = 4;
-constexpr int ATTACK_COOLDOWN = 4;
-constexpr int MIN_CRYSTALS = 10;
-
-struct PlayerMove{
-    std::string dir {};
-    int bombX {}, bombY {};
-    int attackX {}, attackY {};
-
-    PlayerMove() = default;
-    PlayerMove(std::string d, int bX, int bY, int aX, int aY)
-        : dir(d), bombX(bX), bombY(bY), attackX(aX), attackY(aY) {}
-};
+//Plays a game between bots: parses their moves, sends them the game and writes the logs.
+//It is compiled for each set of rules in rules.h, Engine plays the standard game.
+template <typename Rules>
+class BasicEngine{
+public:
+    static constexpr int GRID_SIZE = Rules::GRID_SIZE;
+
+    //Versions of the protocol a bot can ask for on the first turn (see takeProtocolRequest()).
+    //With version 2 the grid is only sent on the first turn, then only the cells that changed.
+    //Version 3 sends the same as version 2 after the first turn, but observations and moves are
+    //binary frames instead of lines of text (see appendFrame() and decodeMove()).
+    //Version 4 sends the same frames through shared memory instead of the pipes (see shm_ring.h),
+    //it is only granted to the bots offered it (see offerSharedMemory()).
+    static constexpr int DELTA_PROTOCOL = 2;
+    static constexpr int BINARY_PROTOCOL = 3;
+    static constexpr int SHM_PROTOCOL = 4;
 
-class Engine{
 private:
-    // Game state
-    std::array<std::array<char, GRID_SIZE>, GRID_SIZE> grid;
+    BasicGame<Rules> game; //The rules and state of the game
 
-    int player1X, player1Y;
-    int player2X, player2Y;
-    int player1HP {INITIAL_HP}, player2HP {INITIAL_HP};
-    int player1Crystals {}, player2Crystals {};
-    int player1BombCooldown {}, player1AttackCooldown {};
-    int player2BombCooldown {}, player2AttackCooldown {};
+    std::array<bool, MAX_PLAYERS> outputReadErrors {};
 
-    bool player1OutputReadError {false};
-    bool player2OutputReadError {false};
+    //Measured time taken by each bot to send its move this turn
+    std::array<std::chrono::microseconds, MAX_PLAYERS> responseTimes {};
 
-    int totalCrystals;
-    int currentTurn {};
-    
-    std::string player1LastMove {};
-    std::string player2LastMove {};
+    //CPU time used by each bot to send its move this turn
+    std::array<std::chrono::microseconds, MAX_PLAYERS> cpuTimes {};
 
-    bool gameOver {false};
-    bool player1Lost {false};
-    bool player2Lost {false};
+    //Number of write syscalls used to send each bot its observation this turn
+    std::array<int, MAX_PLAYERS> writeSyscalls {};
 
-    std::string endReason;
+    std::unique_ptr<LogWriter> logs; //Writes the logs to the logs file as the game goes on
 
-    json logs; //Json object to store logs
-    std::string logsFilePath {"logs.json"}; //Path of the file where logs will be written
+    std::array<int, MAX_PLAYERS> protocols {}; //Protocol version asked for by each bot, 0 for the default
+    std::array<bool, MAX_PLAYERS> multiGame {}; //The bot can play another game once this one is over
+    std::array<bool, MAX_PLAYERS> sharedMemoryOffered {}; //The bot can be granted SHM_PROTOCOL
+    std::array<bool, MAX_PLAYERS> plugins {}; //The bot is a plugin, its moves are frames from the first turn
 
+    std::vector<std::pair<int, int>> changedCells; //(x, y) of the cells changed by the last turn
 
-    // Helper functions
-    bool isValidPosition(int x, int y) const;
-    bool isEmptyCell(int x, int y) const;
-    bool isCrystalCell(int x, int y) const;
-    bool isObstacleCell(int x, int y) const;
-    int manhattanDistance(int x1, int y1, int x2, int y2) const;
+    //Writes the log of this turn to the logs file, moves[i] is the move parsed for players[i].
+    void logTurn(const std::array<PlayerMove, MAX_PLAYERS>& moves);
 
-    std::mt19937 rng; //Random number generator
+    //'1', '2', ... if a player is on (x, y) (the first one if there are several), the cell otherwise
+    char cellMarker(int x, int y) const;
 
-    //Take the input string and retrieve the details of the move.
-    //Returns true if the input format is valid, false otherwise.
-    // bool parseMove(const std::string_view input, PlayerMove& move) const;
-    
-    //Move the player in the specified direction.
-    //Returns true if the move was successful, false otherwise.
-    void initialiseGrid();
-    bool movePlayer(int player, std::string_view move);
-    void getExplosionArea(int x, int y, std::set<std::pair<int, int>>& explosionArea) const;
-    bool parseMove(const std::string_view input, PlayerMove& move) const;
-
-    //Checks win/loss conditions and updates game state accordingly.
-    //If game is over, set the end reason and update gameOver flag.
-    //Returns true if game is over, false otherwise.
-    bool checkGameOver();
-
-    //Adds log of this turn to logs json object.
-    //player1Error flag to be set if there was either an error while reading
-    //their input, the input format was invalid or the move made was invalid.
-    void logTurn(PlayerMove& player1Move, PlayerMove& player2Move);
-
-    //Writes the logs to the appropriate logs file.
+    //Appends "CHANGES n" followed by n lines "x y cell", the cells changed by the last turn
+    void appendChanges(std::string& out) const;
+
+    //Appends the observation of `player` as a binary frame: a 32-bit length (of the rest of the frame),
+    //then 32-bit ints: enemy's last move (a Direction), the 8 numbers of getGameState(), the number
+    //of changed cells and x, y, cell for each of them. All in the byte order of the machine.
+    void appendFrame(std::string& out, int player) const;
+
+    //Appends the grid sent on the first turn with sparse rules: "OBSTACLES n" and "CRYSTALS n",
+    //each followed by n lines "x y" (then only the changes are sent, see appendChanges())
+    void appendSparseGrid(std::string& out) const requires (Rules::SPARSE);
+
+    //Completes the logs file at the end of the game.
     void writeLogs();
 
-    void collectCrystals(int player,
-    std::set<std::pair<int, int>>& explosionArea,
-    std::set<std::pair<int, int>>& explosionArea2);
-    
 public:
-    //`path` is the path to the file where logs (json) will be written
+    //`path` is the path to the file where logs will be written, in the
+    //binary format if it ends in ".cglog" and in JSON otherwise
     //Default value of `path` is "logs.json"
     //Default value of `seed` is static_cast<unsigned>(std::time(nullptr)) (For random seed)
-    Engine();
-    Engine(unsigned seed);
-    Engine(std::string path);
-    Engine(std::string path, unsigned seed);
+    //`players` above 2 plays a free-for-all (see Game)
+    BasicEngine();
+    BasicEngine(unsigned seed);
+    BasicEngine(std::string path);
+    BasicEngine(std::string path, unsigned seed, int players = 2);
+
+    //Take the input string and retrieve the details of the move.
+    //Returns true if the input format is valid, false otherwise.
+    //Does not allocate, `input` need not be null-terminated.
+    static bool parseMove(std::string_view input, PlayerMove& move);
+
+    //A bot asks for a protocol version by ending its first move with "PROTOCOL <version>".
+    //Removes the request from the end of `input` and returns the version, 0 if there is none.
+    static int takeProtocolRequest(std::string_view& input);
+
+    //A bot that can play several games in a row ends its first move with "MULTIGAME"
+    //(before the protocol request if it makes one). Removes it from the end of `input`
+    //and returns true if it is there.
+    static bool takeMultiGameRequest(std::string_view& input);
+
+    //Reads a move sent as a binary frame by a bot using BINARY_PROTOCOL, `frame` being the frame
+    //without its length: five 32-bit ints, the direction (a Direction) and the bomb and attack coordinates.
+    //Returns false if it is not a valid move, with the same checks as parseMove().
+    static bool decodeMove(std::string_view frame, PlayerMove& move);
     
     void printGrid() const;
     void printEndReason() const;
-    void processTurn(std::string_view player1Input, std::string_view player2Input);
+    //inputs[i] is the line sent by players[i], it is not used for eliminated players.
+    //On the first turn a protocol request at the end of the line is taken off and granted
+    //if it is DELTA_PROTOCOL or BINARY_PROTOCOL, other versions are ignored.
+    //The later inputs of bots using BINARY_PROTOCOL or SHM_PROTOCOL are frames (see decodeMove()).
+    void processTurn(const std::array<std::string_view, MAX_PLAYERS>& inputs);
 
     //Use when the input received from (a) player(s) is invalid.
     //Accordingly set the game state and end reason.
-    void outputReadError(bool player1Error, bool player2Error);
+    //In a free-for-all that goes on, the players at fault are only eliminated: the others
+    //then play the turn with processTurn(), which logs it with the errors.
+    void outputReadError(const std::array<bool, MAX_PLAYERS>& readErrors);
+
+    //Lets `player` ask for SHM_PROTOCOL, its bot was given shared memory to talk to the engine
+    void offerSharedMemory(int player);
+
+    //`player` is a bot plugin (see bot_plugin.h): it is not sent text but given a BotObservation
+    //(see getPluginObservation()), and its moves are frames as for BINARY_PROTOCOL, from the first turn.
+    void usePlugin(int player);
+
+    //Records how long each bot took to answer, to be logged with the next turn.
+    void setResponseTimes(const std::array<std::chrono::microseconds, MAX_PLAYERS>& times);
+
+    //Records how much CPU time each bot used to answer, to be logged with the next turn.
+    void setCpuTimes(const std::array<std::chrono::microseconds, MAX_PLAYERS>& times);
+
+    //Records how many write syscalls were used to send each bot its observation, to be logged with the next turn.
+    void setWriteSyscalls(const std::array<int, MAX_PLAYERS>& syscalls);
     
     //Getter functions
-    std::array<std::array<char, GRID_SIZE>, GRID_SIZE> getGrid() const;
+    std::array<std::array<char, Rules::GRID_SIZE>, Rules::GRID_SIZE> getGrid() const requires (!Rules::SPARSE);
     std::string getGridStringPlayersHidden() const;
     std::string getGridString() const;
 
+    //The game being played, to query it directly
+    const BasicGame<Rules>& getGame() const;
+
     int getTotalCrystals() const;
     bool isGameOver() const;
+    int getPlayerCount() const;
+    bool isEliminated(int player) const; //Out of the game, it is not sent observations any more
+    bool usesBinaryProtocol(int player) const; //Sent frames and answers with frames from now on
+    bool usesSharedMemory(int player) const; //The frames go through its shared memory rather than its pipes
+    bool isMultiGame(int player) const; //Asked for MULTIGAME, it can be sent NEWGAME after this game
     int getCurrentTurn() const;
     int getAttackCooldown(int player) const;
     int getBombCooldown(int player) const;
     int getCrystals(int player) const;
     std::string getLastMove(int player) const;
 
+    //Returns 0 if Player 1 won, 1 if Player 2 won, ... and -1 for a tie or an ongoing game
+    int getWinner() const;
+    std::string getEndReason() const;
+
+    //The opponent `player` is told about: the other player, or in a free-for-all
+    //the nearest one still in the game (the first one if several are as near)
+    int getEnemy(int player) const;
+
     std::string getGameState(int player) const;
+
+    //Appends everything `player` is sent at the start of a turn to `out`: the grid size on the
+    //first turn and the enemy's last move on the others, then the game state and the grid.
+    //With sparse rules the grid is sent as lists of cells: the obstacles and crystals
+    //on the first turn, then only the cells that changed, as for the bots using DELTA_PROTOCOL.
+    void appendObservation(std::string& out, int player, bool firstTurn) const;
+
+    //Fills `observation` with what a bot plugin playing `player` is given at the start of a turn:
+    //the grid on the first turn (built in `grid`), the cells that changed on the others (in `changes`).
+    //`observation` points into `grid` and `changes`, which are reused from one turn to the next.
+    void getPluginObservation(int player, bool firstTurn, BotObservation& observation,
+                              std::string& grid, std::vector<std::int32_t>& changes) const;
 };
+
+extern template class BasicEngine<StandardRules>;
+extern template class BasicEngine<Rules32>;
+extern template class BasicEngine<Rules64>;
+extern template class BasicEngine<RulesLarge>;
+
+using Engine = BasicEngine<StandardRules>;
 #endif //engine_h
\ No newline at end of file
@@ -0,0 +1,238 @@
+#ifndef game_h
+#define game_h
+
+#include "../include/bitboard.h"
+#include "../include/move.h"
+#include "../include/rules.h"
+
+#include <string>
+#include <array>
+#include <vector>
+#include <span>
+#include <utility>
+#include <random>
+#include <cstdint>
+#include <type_traits>
+
+//Constants of the standard game, the rules of the other sizes are in rules.h
+constexpr int GRID_SIZE = StandardRules::GRID_SIZE;
+constexpr int MAX_TURNS = StandardRules::MAX_TURNS;
+constexpr int INITIAL_HP = StandardRules::INITIAL_HP;
+constexpr int BOMB_RANGE = StandardRules::BOMB_RANGE; //Including placed cell
+constexpr int ATTACK_RANGE = StandardRules::ATTACK_RANGE; //Including placed cell
+constexpr int BOMB_COOLDOWN = StandardRules::BOMB_COOLDOWN;
+constexpr int ATTACK_COOLDOWN = StandardRules::ATTACK_COOLDOWN;
+constexpr int MIN_CRYSTALS = StandardRules::MIN_CRYSTALS;
+constexpr int MAX_PLAYERS = 8; //Most players in a free-for-all game
+
+enum class EndReason{
+    NONE, //Game is still ongoing
+    BOTH_INVALID_MOVE, PLAYER1_INVALID_MOVE, PLAYER2_INVALID_MOVE,
+    BOTH_DIED_PLAYER1_MORE_CRYSTALS, BOTH_DIED_PLAYER2_MORE_CRYSTALS, BOTH_DIED_SAME_CRYSTALS,
+    PLAYER1_NO_HP, PLAYER2_NO_HP,
+    CRYSTALS_GONE_PLAYER1_MORE_CRYSTALS, CRYSTALS_GONE_PLAYER2_MORE_CRYSTALS,
+    CRYSTALS_GONE_PLAYER1_MORE_HP, CRYSTALS_GONE_PLAYER2_MORE_HP, CRYSTALS_GONE_SAME_HP,
+    MAX_TURNS_PLAYER1_MORE_CRYSTALS, MAX_TURNS_PLAYER2_MORE_CRYSTALS,
+    MAX_TURNS_PLAYER1_MORE_HP, MAX_TURNS_PLAYER2_MORE_HP, MAX_TURNS_SAME_HP,
+    BOTH_READ_ERROR, PLAYER1_READ_ERROR, PLAYER2_READ_ERROR,
+    //Free-for-all games (more than two players), the winner is not part of the reason
+    LAST_PLAYER_STANDING, ALL_ELIMINATED,
+    CRYSTALS_GONE_MOST_CRYSTALS, CRYSTALS_GONE_MOST_HP, CRYSTALS_GONE_TIE,
+    MAX_TURNS_MOST_CRYSTALS, MAX_TURNS_MOST_HP, MAX_TURNS_TIE
+};
+
+//The sentence describing `reason` that is printed and logged,
+//`winner` (0 for Player 1, ...) is only used by the free-for-all reasons
+std::string endReasonText(EndReason reason, int winner = -1, int maxTurns = MAX_TURNS);
+
+//Why the game ends after a turn in which both players made a valid move,
+//EndReason::NONE if it goes on
+EndReason turnEndReason(const std::array<int, 2>& hp, const std::array<int, 2>& crystals,
+                        int totalCrystals, int currentTurn, int maxTurns);
+
+//Returns 0 if Player 1 wins the game ended for `reason`, 1 if Player 2 does and -1 for a tie.
+//Also -1 for the free-for-all reasons, which do not say who won (see Game::getWinner()).
+int endReasonWinner(EndReason reason);
+
+//Cells reached by a bomb or an attack at (x, y): up to BOMB_RANGE - 1 cells in each direction,
+//stopped by obstacles and the edges of the grid. (x, y) may be off the grid.
+template <typename Rules>
+Bitboard<Rules::GRID_SIZE> computeExplosionArea(const Bitboard<Rules::GRID_SIZE>& obstacles, int x, int y);
+
+//The state of one player, `lost` is set when the game ends for every player who did not win.
+//In a free-for-all it is also set as soon as the player is eliminated, the game goes on without them.
+struct PlayerState{
+    int x {}, y {};
+    int hp {INITIAL_HP};
+    int crystals {};
+    int bombCooldown {}, attackCooldown {};
+    Direction lastMove {Direction::NONE};
+    bool lost {false};
+};
+
+//End reason of a two-player game ended by the players who lost (`lost` is set):
+//`all` if both did, `player1` or `player2` if only that player did
+EndReason faultReason(const std::array<PlayerState, MAX_PLAYERS>& players,
+                      EndReason all, EndReason player1, EndReason player2);
+
+//Why a free-for-all of `playerCount` players ends after a turn, EndReason::NONE if it goes on.
+//Players with no HP left must already be marked as lost. Sets `winner` to the player who wins,
+//-1 for a tie. The game ends when at most one player is left, or when the crystals are gone
+//or `maxTurns` have been played: then of the players left the one with the most crystals wins,
+//or with the most HP if several have the most crystals.
+EndReason freeForAllEndReason(const std::array<PlayerState, MAX_PLAYERS>& players, int playerCount,
+                              int totalCrystals, int currentTurn, int maxTurns, int& winner);
+
+//Everything about a game that changes during play. It is a plain struct
+//(no pointers, trivially copyable) so a search can save and restore it cheaply,
+//the map that never changes (obstacles, explosion areas) is kept in Game.
+//On the sparse maps the crystals are a ChunkedGrid, which is copied with the state.
+template <typename Rules>
+struct BasicGameState{
+    typename Rules::Cells::Grid crystals;
+
+    std::array<PlayerState, MAX_PLAYERS> players; //players[0] is Player 1, only the first playerCount are used
+    int playerCount {2};
+
+    int totalCrystals {};
+    int currentTurn {};
+
+    bool gameOver {false};
+
+    EndReason endReason {EndReason::NONE};
+
+    //Zobrist hash of the state except the last moves and how the game ended
+    //(players who lost are part of it, in a free-for-all the game goes on without them),
+    //kept up to date as they change (see Game::computeHash())
+    std::uint64_t hash {};
+};
+
+//The rules of the game on their own: typed moves in, next state out.
+//There is no move parsing, logging or I/O here so it can be used directly
+//for simulations (the Engine wraps it to play bots against each other).
+//It is compiled for each set of rules in rules.h, Game is the standard game.
+//How the map is stored depends on the rules (Rules::Cells, see cell_storage.h): bitboards and
+//an explosion table, or for the maps too large for them (e.g. 1000 x 1000) ChunkedGrids and
+//explosions computed when a bomb is placed, so a turn only touches the cells around the players.
+template <typename Rules>
+class BasicGame{
+public:
+    //The constants of these rules, used in place of the standard ones by the code of the class
+    static constexpr int GRID_SIZE = Rules::GRID_SIZE;
+    static constexpr int MAX_TURNS = Rules::MAX_TURNS;
+    static constexpr int INITIAL_HP = Rules::INITIAL_HP;
+    static constexpr int BOMB_RANGE = Rules::BOMB_RANGE;
+    static constexpr int ATTACK_RANGE = Rules::ATTACK_RANGE;
+    static constexpr int BOMB_COOLDOWN = Rules::BOMB_COOLDOWN;
+    static constexpr int ATTACK_COOLDOWN = Rules::ATTACK_COOLDOWN;
+    static constexpr int MIN_CRYSTALS = Rules::MIN_CRYSTALS;
+
+    using Cells = typename Rules::Cells;
+
+private:
+    BasicGameState<Rules> state;
+
+    //The obstacles and the explosion areas, the char grid is only built when it is sent or printed
+    Cells cells;
+
+    std::vector<std::pair<int, int>> changedCells; //(x, y) of the crystals removed by the last turn, sparse maps only
+
+    // Helper functions
+    bool isEmptyCell(int x, int y) const;
+    bool isCrystalCell(int x, int y) const;
+    bool isObstacleCell(int x, int y) const;
+    int manhattanDistance(int x1, int y1, int x2, int y2) const;
+    char cellChar(int x, int y) const; //'#', 'C' or '.'
+
+    void initialiseGrid(std::mt19937& rng);
+    void placeCellsRejecting(std::mt19937& rng, int obstacleCount);
+    void placeCellsDistinct(std::mt19937& rng, int obstacleCount);
+    void drawTotalCrystals(std::mt19937& rng);
+    void placePlayers(std::mt19937& rng);
+
+    void setLost(int player, bool lost);
+
+    //Checks `move` against the rules, except for the cell the player moves to (see movePlayer())
+    bool isValidMove(const PlayerState& player, const PlayerMove& move) const;
+
+    //Move the player in the specified direction.
+    //Returns true if the move was successful, false otherwise.
+    bool movePlayer(int player, Direction move);
+
+    //Checks win/loss conditions and updates game state accordingly.
+    //If game is over, set the end reason and update gameOver flag.
+    //Returns true if game is over, false otherwise.
+    bool checkGameOver();
+    bool checkFreeForAllOver(); //checkGameOver() for more than two players
+
+    //`explosionAreas[i]` is the area of the bomb of players[i] (empty if there is none)
+    void collectCrystals(int player, std::span<const typename Cells::AreaRef> explosionAreas);
+
+public:
+    //Generates the map from `seed`, with `players` players (2 to MAX_PLAYERS).
+    //With more than two players it is a free-for-all: players who make an invalid move,
+    //fail to send one or lose all HP are eliminated and the others play on.
+    explicit BasicGame(unsigned seed, int players = 2);
+
+    static bool isValidPosition(int x, int y);
+
+    //Plays one turn, moves[i] is the move of players[i]. A move that is against the rules
+    //(or has Direction::NONE, for moves that could not be parsed) loses the game for that player.
+    //Moves past the player count and of eliminated players are ignored.
+    void playTurn(const std::array<PlayerMove, MAX_PLAYERS>& moves);
+
+    //Ends the game as no move could be read from the players with readError set this turn.
+    //In a free-for-all these players are only eliminated: unless at most one player is left (which ends
+    //the game and the turn), the others then play the turn with playTurn().
+    void forfeit(const std::array<bool, MAX_PLAYERS>& readError);
+
+    //Saves/restores the state of the game, e.g. to explore moves in a search.
+    //The state can only be restored into the Game (the map) it was taken from.
+    //On the sparse maps this copies the whole crystal grid.
+    const BasicGameState<Rules>& snapshot() const;
+    void restore(const BasicGameState<Rules>& saved);
+
+    //Plays a turn like playTurn() and returns what unmakeTurn() needs to undo it
+    BasicGameState<Rules> makeTurn(const std::array<PlayerMove, MAX_PLAYERS>& moves);
+    void unmakeTurn(const BasicGameState<Rules>& undo);
+
+    //Getter functions, `player` is 0 for Player 1 and 1 for Player 2
+    char getCell(int x, int y) const; //'#', 'C' or '.'
+    const typename Cells::Grid& getCrystalCells() const;
+    const typename Cells::Grid& getObstacleCells() const;
+
+    //(x, y) of the cells that changed in the last turn (the crystals it removed)
+    const std::vector<std::pair<int, int>>& getChangedCells() const requires (Rules::SPARSE);
+
+    int getTotalCrystals() const;
+    bool isGameOver() const;
+    int getCurrentTurn() const;
+    int getPlayerCount() const;
+    const PlayerState& getPlayer(int player) const;
+    int getX(int player) const;
+    int getY(int player) const;
+    int getHP(int player) const;
+    int getCrystals(int player) const;
+    int getBombCooldown(int player) const;
+    int getAttackCooldown(int player) const;
+    Direction getLastMove(int player) const;
+
+    //Returns the index of the player who won (0 for Player 1, ...) and -1 for a tie or an ongoing game
+    int getWinner() const;
+    EndReason getEndReason() const;
+
+    //64-bit hash of the game state, e.g. for transposition tables.
+    //It is updated incrementally, computeHash() recomputes it from scratch.
+    std::uint64_t getHash() const;
+    std::uint64_t computeHash() const;
+};
+
+extern template class BasicGame<StandardRules>;
+extern template class BasicGame<Rules32>;
+extern template class BasicGame<Rules64>;
+extern template class BasicGame<RulesLarge>;
+
+using Game = BasicGame<StandardRules>;
+using GameState = BasicGameState<StandardRules>;
+static_assert(std::is_trivially_copyable_v<GameState>);
+#endif //game_h
@@ -0,0 +1,83 @@
+#ifndef log_writer_h
+#define log_writer_h
+
+#include "../include/nlohmann_json.hpp"
+#include "../include/move.h"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <fstream>
+
+using json = nlohmann::json;
+
+//Everything logged about one player on one turn
+struct PlayerRecord{
+    bool readError {false}; //The move is logged as "ERROR"
+    bool eliminated {false}; //Out of a free-for-all game, only logged with more than two players
+    PlayerMove move;
+    int x {}, y {};
+    int hp {}, crystals {};
+    int attackCooldown {}, bombCooldown {};
+    std::chrono::microseconds responseTime {};
+    std::chrono::microseconds cpuTime {};
+    int writeSyscalls {};
+};
+
+//Everything logged about one turn
+struct TurnRecord{
+    int turn {};
+    std::vector<PlayerRecord> players; //players[0] is Player 1
+    bool gameOver {false};
+    int winner {-1}; //Only if gameOver: 0 for Player 1, 1 for Player 2, ..., -1 for a tie
+    std::string endReason; //Only if gameOver
+};
+
+//Destination of the game log, written entry by entry (the grid, then each turn)
+//as the game is played.
+class LogWriter{
+public:
+    virtual ~LogWriter() = default;
+
+    //The grid after the first turn, as returned by Engine::getGridString(),
+    //with the markers '1' up to '0' + players
+    virtual void writeGrid(const std::string& grid, int players) = 0;
+    virtual void writeTurn(const TurnRecord& turn) = 0;
+
+    //Completes the log, later writes are ignored
+    virtual void finish() = 0;
+};
+
+//Writes the log as a JSON object, one entry at a time, so memory use does not
+//depend on the length of the game and every completed turn is already on disk
+//if the engine crashes. If the engine dies before finish() only the closing brace is missing.
+class JsonLogWriter : public LogWriter{
+private:
+    std::string path;
+    std::ofstream file;
+    bool empty {true}; //No entry has been written yet
+    bool finished {false};
+
+    //Appends `"key": value` to the logs and flushes it to disk
+    void write(const std::string& key, const json& value);
+
+public:
+    //The file is only created when the first entry is written
+    explicit JsonLogWriter(std::string path);
+    ~JsonLogWriter() override;
+
+    void writeGrid(const std::string& grid, int players) override;
+    void writeTurn(const TurnRecord& turn) override;
+    void finish() override;
+
+    //The JSON object logged for `turn`
+    static json turnToJson(const TurnRecord& turn);
+};
+
+//Binary logs are picked by the file extension, anything else is logged as JSON
+inline constexpr std::string_view binaryLogExtension {".cglog"};
+
+//Creates the writer for the log format matching the extension of `path`
+std::unique_ptr<LogWriter> makeLogWriter(const std::string& path);
+#endif //log_writer_h
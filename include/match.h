@@ -0,0 +1,53 @@
+#ifndef match_h
+#define match_h
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <algorithm>
+
+#include "../include/rules.h"
+
+class BotPool;
+
+inline constexpr std::chrono::milliseconds defaultResponseTimeLimit {1000};
+
+//The clock a bot's time to answer is measured on to decide whether it timed out
+enum class TimeoutClock{
+    CPU, //The CPU time its process used, so that it is not forfeited for being descheduled on a loaded host
+    WALL //The time elapsed since it was sent its observation
+};
+
+//With TimeoutClock::CPU a bot that does not use up its CPU time (e.g. it is waiting) is still only
+//waited for until this wall-clock backstop for the time limit `limit`
+inline std::chrono::milliseconds wallClockBackstop(std::chrono::milliseconds limit){
+    return std::max(3 * limit, limit + std::chrono::milliseconds(1000));
+}
+
+struct MatchConfig{
+    std::vector<std::string> botPaths; //Paths to the compiled executables of the bots, more than two play a free-for-all
+    std::string logsPath {"logs.json"};
+    std::optional<unsigned> seed {}; //Random seed if not set
+    bool verbose {true}; //Print the grid every turn and the end reason
+    std::chrono::milliseconds responseTimeLimit {defaultResponseTimeLimit}; //Time each bot gets to answer every turn
+    TimeoutClock timeoutClock {TimeoutClock::CPU}; //What the time limit is measured on, both are logged
+    int gridSize {StandardRules::GRID_SIZE}; //One of GRID_SIZES, picks the rules the match is played with
+    std::vector<bool> sharedMemory {}; //sharedMemory[i] offers bot i a shared-memory transport (see SHM_PROTOCOL)
+    std::vector<bool> plugins {}; //plugins[i] if botPaths[i] is a bot plugin (see bot_plugin.h) rather than an executable
+    BotPool* pool {nullptr}; //Takes the bots from it and gives them back after the match if set, launches them otherwise
+    std::vector<int> cpus {}; //If set, pins bot i (and its plugin thread) to cpus[i % size] and the thread playing the match to cpus[players % size]
+};
+
+struct MatchResult{
+    int winner {-1}; //0 for Player 1, 1 for Player 2, ..., -1 for a tie
+    int turns {};
+    std::string endReason;
+    std::vector<std::vector<std::chrono::microseconds>> responseTimes; //responseTimes[i] has the time bot i took every turn it played
+};
+
+//Plays a single match between already compiled bots (2 to MAX_PLAYERS of them).
+//Unlike the old single match flow this never exits the program so that
+//many matches can be played by the same process (and in parallel).
+MatchResult playMatch(const MatchConfig& config);
+#endif //match_h
@@ -0,0 +1,33 @@
+#ifndef move_h
+#define move_h
+
+#include <string_view>
+
+//NONE is only used for moves that could not be parsed
+enum class Direction { NONE, UP, DOWN, LEFT, RIGHT };
+
+//Returns "UP", "DOWN", "LEFT", "RIGHT" (or "" for NONE)
+constexpr std::string_view directionName(Direction dir){
+    switch(dir){
+        case Direction::UP: return "UP";
+        case Direction::DOWN: return "DOWN";
+        case Direction::LEFT: return "LEFT";
+        case Direction::RIGHT: return "RIGHT";
+        default: return "";
+    }
+}
+
+struct PlayerMove{
+    Direction dir {Direction::NONE};
+    int bombX {}, bombY {};
+    int attackX {}, attackY {};
+
+    PlayerMove() = default;
+    PlayerMove(Direction d, int bX, int bY, int aX, int aY)
+        : dir(d), bombX(bX), bombY(bY), attackX(aX), attackY(aY) {}
+
+    //A bomb/attack at (-1, -1) means none was placed/made this turn
+    bool placesBomb() const { return !(bombX == -1 && bombY == -1); }
+    bool attacks() const { return !(attackX == -1 && attackY == -1); }
+};
+#endif //move_h
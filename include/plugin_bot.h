@@ -0,0 +1,63 @@
+#ifndef plugin_bot_h
+#define plugin_bot_h
+
+#include "../include/bot_plugin.h"
+#include "../include/util.h"
+
+#include <string>
+#include <optional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+//A bot plugin (see bot_plugin.h) playing one game. Its calls run on a thread of its own, which the
+//match waits for until the deadline: a move that is not back by then, or that used more CPU time
+//than allowed, is no move at all. Such a call cannot be interrupted, so it is left to finish on its
+//thread and the plugin is refused for the rest of the run: every later call to it, in any game, is no move.
+class PluginBot{
+public:
+    //The functions exported by a plugin
+    struct Library{
+        decltype(&bot_init) init;
+        decltype(&bot_act) act;
+        decltype(&bot_free) free;
+    };
+
+private:
+    struct Worker; //What a call shares with the thread running it
+
+    std::string path;
+    const Library& library;
+    std::shared_ptr<Worker> worker; //Also held by the thread, which outlives the bot if a call missed its deadline
+    std::thread thread; //Not joinable if the plugin was refused
+    bool calling = false; //call() started a turn that wait() has not waited for
+    std::chrono::nanoseconds callCpuStart {}; //CPU time of the thread when the turn started
+
+    //Runs the calls handed to `worker` until it is stopped, then ends the game.
+    //`library` is copied, the thread may still be running when the engine exits.
+    static void run(Library library, std::shared_ptr<Worker> worker);
+
+public:
+    //Loads the plugin at `path` (once for the whole engine) and starts a game with it, unless it was refused.
+    //Exits the program if it cannot be loaded.
+    explicit PluginBot(const std::string& path);
+    PluginBot(const PluginBot&) = delete;
+    PluginBot& operator=(const PluginBot&) = delete;
+    ~PluginBot();
+
+    //Starts a turn: the plugin is called on its thread with a copy of `observation`, unless it was refused.
+    //The call runs while the engine does something else, e.g. waits for the other bots.
+    void call(const BotObservation& observation);
+
+    //Waits for the move of the turn started by call(), which was sent at `start`. The move is returned as a frame
+    //(see Engine::decodeMove()), or not at all if the plugin did not return by `start + deadline`,
+    //used more CPU time than `cpuLimit` or was refused, with the time and the CPU time it took.
+    PipeReply wait(std::chrono::steady_clock::time_point start, std::chrono::milliseconds deadline,
+                   std::optional<std::chrono::milliseconds> cpuLimit = std::nullopt);
+
+    //Restricts the thread running the calls to `cpus`, returns false if it could not be
+    bool pinToCpus(const std::vector<int>& cpus);
+    const std::string& getPath() const;
+};
+#endif //plugin_bot_h
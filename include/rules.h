@@ -0,0 +1,57 @@
+#ifndef rules_h
+#define rules_h
+
+#include "../include/cell_storage.h"
+
+#include <array>
+
+//Constants of the rules of a game. Game and Engine are templates on them and compiled
+//for each set of rules below, so the grid loops and the arrays sized by the grid are
+//fixed at compile time whichever size is played.
+template <int GridSize, int MaxTurns, int MinCrystals>
+struct BasicRules{
+    static constexpr int GRID_SIZE = GridSize;
+    static constexpr int MAX_TURNS = MaxTurns;
+    static constexpr int INITIAL_HP = 5;
+    static constexpr int BOMB_RANGE = 3; //Including placed cell
+    static constexpr int ATTACK_RANGE = 3; //Including placed cell
+    static constexpr int BOMB_COOLDOWN = 4;
+    static constexpr int ATTACK_COOLDOWN = 4;
+    static constexpr int MIN_CRYSTALS = MinCrystals;
+    static constexpr bool SPARSE = false;
+    using Cells = BitboardCells<GridSize, BOMB_RANGE>; //How the game stores the map, see cell_storage.h
+};
+
+//Rules of a map too large for bitboards: the game keeps it in ChunkedGrids and
+//only the cells that change are sent to the bots after the first turn
+template <int GridSize, int MaxTurns, int MinCrystals>
+struct SparseRules : BasicRules<GridSize, MaxTurns, MinCrystals>{
+    static constexpr bool SPARSE = true;
+    using Cells = ChunkedCells<GridSize, BasicRules<GridSize, MaxTurns, MinCrystals>::BOMB_RANGE>;
+};
+
+//The standard game
+using StandardRules = BasicRules<20, 100, 10>;
+//Larger maps, with as many crystals per cell and as many turns per cell crossed as the standard game
+using Rules32 = BasicRules<32, 160, 25>;
+using Rules64 = BasicRules<64, 320, 100>;
+using RulesLarge = SparseRules<1000, 5000, 25000>;
+
+//Grid sizes that can be played, one for each set of rules above
+inline constexpr std::array<int, 4> GRID_SIZES {
+    StandardRules::GRID_SIZE, Rules32::GRID_SIZE, Rules64::GRID_SIZE, RulesLarge::GRID_SIZE
+};
+
+//Calls f(Rules{}) with the rules for `gridSize` and returns true,
+//or returns false if there are none for that size
+template <typename F>
+bool withRules(int gridSize, F&& f){
+    switch(gridSize){
+        case StandardRules::GRID_SIZE: f(StandardRules{}); return true;
+        case Rules32::GRID_SIZE: f(Rules32{}); return true;
+        case Rules64::GRID_SIZE: f(Rules64{}); return true;
+        case RulesLarge::GRID_SIZE: f(RulesLarge{}); return true;
+        default: return false;
+    }
+}
+#endif //rules_h
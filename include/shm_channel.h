@@ -0,0 +1,44 @@
+#ifndef shm_channel_h
+#define shm_channel_h
+
+#include "../include/shm_ring.h"
+#include "../include/util.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+
+//The engine's end of the shared memory of one bot (see shm_ring.h). The memory is created
+//with a name of its own, which is given to the bot in its environment (SHM_ENV),
+//and removed when the channel is destroyed.
+class ShmChannel{
+private:
+    std::string name;
+    ShmSegment* segment {nullptr};
+
+public:
+    //Creates the shared memory, exits the program if it cannot
+    ShmChannel();
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+    ~ShmChannel();
+
+    const std::string& getName() const;
+
+    //Sends `frame` (its length included) to the bot.
+    //Returns false if it does not fit in what is left of the ring.
+    bool send(std::string_view frame);
+
+    ShmRing& fromBot();
+};
+
+//Reads one frame from each channel with a single deadline shared by all of them, as readPipesDeadline()
+//does for pipes. The frames without their length are returned as the lines of the replies.
+//The engine waits for one bot at a time, so the latency of a bot is measured from the time
+//it pushed its frame (see ShmRing::pushedAt) rather than from when the engine read it.
+//`cpu` measures and judges the CPU time of the bots as for readPipesDeadline().
+std::vector<PipeReply> readChannelsDeadline(const std::vector<ShmChannel*>& channels,
+                      std::chrono::steady_clock::time_point start, std::chrono::milliseconds deadline,
+                      const CpuBudget* cpu = nullptr);
+#endif //shm_channel_h
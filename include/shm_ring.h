@@ -0,0 +1,143 @@
+#ifndef shm_ring_h
+#define shm_ring_h
+
+//The shared memory through which the engine and a bot using protocol version 4 exchange frames
+//(see Game_Description.md): one single-producer single-consumer ring each way, with a futex to
+//sleep on when a ring is empty. It is included by the engine and by bots (through bots/bot_sdk.h),
+//so it only uses the standard library and Linux system calls.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+//Environment variable holding the name of the shared memory (for shm_open()) of a bot offered it
+inline constexpr const char* SHM_ENV = "CG_SHM";
+
+//Frames (a 32-bit length and the payload) pushed by one process and popped by the other
+struct ShmRing{
+    static constexpr std::uint32_t CAPACITY = 1 << 16; //Bytes, a power of two
+    static constexpr std::uint32_t MAX_PAYLOAD = CAPACITY - sizeof(std::uint32_t); //Longest frame that fits, without its length
+
+    alignas(64) std::atomic<std::uint32_t> head {}; //Bytes pushed so far, only written by the producer
+    alignas(64) std::atomic<std::uint32_t> tail {}; //Bytes popped so far, only written by the consumer
+    alignas(64) std::atomic<std::uint32_t> wake {}; //Futex word, bumped after each frame pushed
+    std::atomic<std::uint32_t> sleeping {}; //Set while the consumer waits on `wake`
+    std::atomic<std::int64_t> pushedAt {}; //CLOCK_MONOTONIC time of the last frame pushed, in ns
+    alignas(64) char data[CAPACITY];
+};
+
+struct ShmSegment{
+    ShmRing toBot; //Observations
+    ShmRing toEngine; //Moves
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::int64_t>::is_always_lock_free,
+              "The rings are shared between processes");
+
+//CLOCK_MONOTONIC in ns, the clock of std::chrono::steady_clock on Linux
+inline std::int64_t shmNow(){
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return std::int64_t{now.tv_sec} * 1'000'000'000 + now.tv_nsec;
+}
+
+//Copies between the ring and `bytes`, wrapping around the end of the ring
+inline void shmCopyIn(ShmRing& ring, std::uint32_t at, const char* bytes, std::uint32_t size){
+    std::uint32_t offset = at & (ShmRing::CAPACITY - 1);
+    std::uint32_t first = size < ShmRing::CAPACITY - offset ? size : ShmRing::CAPACITY - offset;
+    std::memcpy(ring.data + offset, bytes, first);
+    std::memcpy(ring.data, bytes + first, size - first);
+}
+
+inline void shmCopyOut(const ShmRing& ring, std::uint32_t at, char* bytes, std::uint32_t size){
+    std::uint32_t offset = at & (ShmRing::CAPACITY - 1);
+    std::uint32_t first = size < ShmRing::CAPACITY - offset ? size : ShmRing::CAPACITY - offset;
+    std::memcpy(bytes, ring.data + offset, first);
+    std::memcpy(bytes + first, ring.data, size - first);
+}
+
+//Pushes `frame` (its length included) and wakes the consumer if it sleeps.
+//Returns false if there is not enough room left in the ring for it.
+inline bool shmPush(ShmRing& ring, const char* frame, std::uint32_t size){
+    std::uint32_t head = ring.head.load(std::memory_order_relaxed);
+    if(ShmRing::CAPACITY - (head - ring.tail.load(std::memory_order_acquire)) < size){
+        return false;
+    }
+    shmCopyIn(ring, head, frame, size);
+    ring.pushedAt.store(shmNow(), std::memory_order_relaxed);
+    ring.head.store(head + size);
+    //Either the consumer sees the new head before it sleeps or this sees it sleeping
+    ring.wake.fetch_add(1);
+    if(ring.sleeping.load()){
+        syscall(SYS_futex, &ring.wake, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+    return true;
+}
+
+//Length of the payload of the frame at the front of the ring, -1 if it is empty.
+//The other process is not trusted: -2 if the length is over `maxLength` (at most MAX_PAYLOAD)
+//or over what was pushed, the frame must then not be popped and the ring can no longer be read.
+inline std::int64_t shmFrontLength(const ShmRing& ring, std::uint32_t maxLength){
+    std::uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    std::uint32_t pushed = ring.head.load(std::memory_order_acquire) - tail;
+    if(pushed == 0){
+        return -1;
+    }
+    std::uint32_t length;
+    if(pushed < sizeof(length)){
+        return -2;
+    }
+    shmCopyOut(ring, tail, reinterpret_cast<char*>(&length), sizeof(length));
+    if(length > maxLength || length > pushed - sizeof(length)){
+        return -2;
+    }
+    return length;
+}
+
+//Pops the frame at the front of the ring into `payload`, `length` being what shmFrontLength()
+//returned for it (the length in the ring is not read again, the other process may have changed it)
+inline void shmPop(ShmRing& ring, char* payload, std::uint32_t length){
+    std::uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    shmCopyOut(ring, tail + sizeof(length), payload, length);
+    ring.tail.store(tail + static_cast<std::uint32_t>(sizeof(length)) + length, std::memory_order_release);
+}
+
+//Waits until the ring is not empty, spinning for a little while before sleeping on the futex.
+//`deadline` is a CLOCK_MONOTONIC time in ns, -1 to wait for ever. Returns false if it passed first.
+inline bool shmWait(ShmRing& ring, std::int64_t deadline){
+    //Spinning only helps if the producer can run at the same time
+    static const int spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 4096 : 0;
+    for(int i = 0; i < spins; ++i){
+        if(ring.head.load(std::memory_order_acquire) != ring.tail.load(std::memory_order_relaxed)){
+            return true;
+        }
+    }
+    while(true){
+        std::uint32_t wake = ring.wake.load();
+        ring.sleeping.store(1);
+        if(ring.head.load() != ring.tail.load(std::memory_order_relaxed)){
+            ring.sleeping.store(0);
+            return true;
+        }
+        timespec timeout {};
+        timespec* wait = nullptr;
+        if(deadline >= 0){
+            std::int64_t left = deadline - shmNow();
+            if(left <= 0){
+                ring.sleeping.store(0);
+                return false;
+            }
+            timeout.tv_sec = left / 1'000'000'000;
+            timeout.tv_nsec = left % 1'000'000'000;
+            wait = &timeout;
+        }
+        //Not FUTEX_PRIVATE_FLAG, the word is shared with another process
+        syscall(SYS_futex, &ring.wake, FUTEX_WAIT, wake, wait, nullptr, 0);
+        ring.sleeping.store(0);
+    }
+}
+#endif //shm_ring_h
@@ -0,0 +1,34 @@
+#ifndef tournament_h
+#define tournament_h
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "match.h"
+
+struct TournamentConfig{
+    std::vector<std::string> botSources; //Paths to the .cpp files of the bots
+    int seeds {1}; //Number of maps every pairing is played on
+    unsigned threads {1}; //Number of matches played at the same time
+    unsigned baseSeed {1}; //Seed of the first map, the rest use baseSeed + 1, baseSeed + 2, ...
+    std::string outDir {"tournament"}; //Directory for the match logs and results table
+    std::chrono::milliseconds responseTimeLimit {defaultResponseTimeLimit}; //Time each bot gets to answer every turn
+    TimeoutClock timeoutClock {TimeoutClock::CPU}; //What the time limit is measured on
+    bool binaryLogs {false}; //Write the match logs in the compact binary format instead of JSON
+    int players {2}; //Bots in each match, more than two play free-for-alls
+    int gridSize {StandardRules::GRID_SIZE}; //One of GRID_SIZES
+    std::vector<bool> sharedMemory {}; //sharedMemory[i] offers botSources[i] a shared-memory transport
+    std::vector<bool> plugins {}; //plugins[i] builds botSources[i] as a bot plugin the engine calls (see bot_plugin.h)
+    bool reuseBots {false}; //Keep the bots that ask for MULTIGAME running from one match to the next (see BotPool)
+    int matchesPerCore {0}; //Pin every thread's matches to a set of cores (one per bot and one for the thread) shared by this many threads, 0 to not pin
+};
+
+//Builds every bot once and plays a round-robin between them.
+//Every pair of bots plays on each seed twice, once from each side of the map.
+//With more than two players every group of `players` bots plays once on each seed,
+//the seats rotating from one seed to the next.
+//Prints the standings and the spread of the time every bot took to answer.
+//Returns 0 on success.
+int runTournament(const TournamentConfig& config);
+#endif //tournament_h
@@ -3,16 +3,78 @@
 
 #include <boost/process.hpp>
 #include <boost/asio.hpp>
-#include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <string>
+#include <string_view>
 #include <optional>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <sys/types.h>
 
 namespace bp = boost::process;
 namespace asio = boost::asio;
 
-inline constexpr int responseTimeLimit = 1; //seconds
-void buildCpp(std::string code_path, std::string out_name);
-std::optional<std::string> readPipeDeadline(bp::async_pipe &readPipe, asio::io_context &ctx,
-                      boost::posix_time::seconds deadline);
+inline const std::string cacheDir {"bin/cache"};
+
+//Compiles the bot at `code_path` unless an identical build (same source, compiler
+//version and flags) is already in the cache and returns the path to the executable.
+//Only the source file itself is hashed, not the headers it includes.
+//With `plugin` it is built as a shared object to be loaded by the engine (see bot_plugin.h).
+std::string buildCpp(std::string code_path, bool plugin = false);
+
+//Writes all of `data` to the pipe, with a single write() unless the pipe is too full to take it at once.
+//Returns the number of write() syscalls made, or -1 if the pipe is broken.
+int writePipe(bp::pipe& pipe, std::string_view data);
+
+//Writes all of data[i] to pipes[i], as writePipe() but to all of them at once: a pipe that is too full
+//does not hold up the others. The pipes of the bots are non-blocking, those are waited for
+//until `deadline` at most, and a pipe that has not taken all of its data by then is given up on.
+//Returns the number of write() syscalls made to each pipe, or -1 if it is broken or was given up on.
+std::vector<int> writePipesDeadline(const std::vector<bp::pipe*>& pipes, const std::vector<std::string_view>& data,
+                                    std::chrono::steady_clock::time_point deadline);
+
+//Largest frame a bot may send, a longer one is a read error for that bot
+inline constexpr std::uint32_t MAX_FRAME_SIZE = 1024;
+
+struct PipeReply{
+    std::optional<std::string> line; //std::nullopt if no line (or frame) was delivered in time
+    std::chrono::microseconds latency {}; //Time taken to answer (the deadline if it never did)
+    std::chrono::microseconds cpuTime {}; //CPU time used to answer, zero if it was not measured
+};
+
+//CPUs the calling thread may run on (see sched_getaffinity())
+std::vector<int> availableCpus();
+
+//Restricts the process `pid` (the calling thread for 0) to run on `cpus`, see sched_setaffinity().
+//Returns false if it could not be.
+bool pinToCpus(pid_t pid, const std::vector<int>& cpus);
+
+//CPU clock of the process `pid`, all its threads included (see clock_getcpuclockid()), -1 if there is none
+clockid_t processCpuClock(pid_t pid);
+
+//Time of a CPU clock, zero if it cannot be read (e.g. the process is gone)
+std::chrono::nanoseconds cpuTime(clockid_t clock);
+
+//Measures the CPU time the bots use to answer a turn and, if `limit` is set, judges them on it
+struct CpuBudget{
+    std::vector<clockid_t> clocks; //clocks[i] is the CPU clock of the process answering on the i-th pipe
+    std::vector<std::chrono::nanoseconds> startTimes; //Their times when the bots were sent their input
+    std::optional<std::chrono::milliseconds> limit; //A bot using more CPU time than this has timed out
+};
+
+//Reads one line from each pipe concurrently on `ctx`, with a single deadline shared by all of them.
+//The deadline and the latencies are measured from `start` (when the bots were sent their input)
+//on a monotonic clock. Returns as soon as every pipe has answered or the deadline has passed.
+//All the pipes must use `ctx` as their io_context.
+//If framed[i] is set, pipe i is read a binary frame instead of a line: a 32-bit length in the
+//byte order of the machine followed by that many bytes, which are returned as the line. A frame
+//longer than MAX_FRAME_SIZE is a read error, the rest of that stream is then out of step.
+//With `cpu` the CPU time of every bot is measured, and with a CPU limit a bot going over it is
+//stopped being waited for and its answer is dropped, the deadline only being a wall-clock backstop.
+std::vector<PipeReply> readPipesDeadline(const std::vector<bp::async_pipe*>& readPipes,
+                      asio::io_context &ctx, std::chrono::steady_clock::time_point start,
+                      std::chrono::milliseconds deadline, const std::vector<bool>& framed = {},
+                      const CpuBudget* cpu = nullptr);
 #endif //util_h
\ No newline at end of file
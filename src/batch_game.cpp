@@ -0,0 +1,247 @@
+#include "../include/batch_game.h"
+#include "../include/game.h"
+#include <array>
+#include <vector>
+#include <span>
+#include <cstdlib>
+#include <cassert>
+#include <algorithm>
+
+BatchGame::BatchGame(const std::vector<unsigned>& seeds)
+: count {static_cast<int>(seeds.size())}
+{
+    std::size_t n = seeds.size();
+    crystals.resize(n);
+    obstacles.resize(n);
+    totalCrystals.resize(n);
+    currentTurn.resize(n);
+    gameOver.resize(n);
+    endReason.resize(n);
+    for(int player = 0; player < PLAYERS; player++){
+        x[player].resize(n);
+        y[player].resize(n);
+        hp[player].resize(n);
+        crystalCount[player].resize(n);
+        bombCooldown[player].resize(n);
+        attackCooldown[player].resize(n);
+        lastMove[player].resize(n);
+        valid[player].resize(n);
+        bombed[player].resize(n);
+        attacked[player].resize(n);
+    }
+
+    for(int game = 0; game < count; game++){
+        resetGame(game, seeds[static_cast<std::size_t>(game)]);
+    }
+}
+
+void BatchGame::resetGame(int game, unsigned seed){
+    //The map is generated by Game so both give the same game for a seed
+    Game source(seed);
+
+    crystals[game] = source.getCrystalCells();
+    obstacles[game] = source.getObstacleCells();
+    totalCrystals[game] = source.getTotalCrystals();
+    currentTurn[game] = source.getCurrentTurn();
+    gameOver[game] = source.isGameOver();
+    endReason[game] = source.getEndReason();
+    for(int player = 0; player < PLAYERS; player++){
+        x[player][game] = source.getX(player);
+        y[player][game] = source.getY(player);
+        hp[player][game] = source.getHP(player);
+        crystalCount[player][game] = source.getCrystals(player);
+        bombCooldown[player][game] = source.getBombCooldown(player);
+        attackCooldown[player][game] = source.getAttackCooldown(player);
+        lastMove[player][game] = source.getLastMove(player);
+    }
+}
+
+bool BatchGame::isEmptyCell(int game, int cellX, int cellY) const{
+    return Game::isValidPosition(cellX, cellY) &&
+           !crystals[game].test(cellX, cellY) && !obstacles[game].test(cellX, cellY);
+}
+
+void BatchGame::step(std::span<const PlayerMove> player1Moves, std::span<const PlayerMove> player2Moves){
+    assert(player1Moves.size() == crystals.size() && player2Moves.size() == crystals.size());
+    std::array<std::span<const PlayerMove>, PLAYERS> moves {player1Moves, player2Moves};
+
+    //Validate the moves, a valid move is made even if the other player's move is not
+    for(int player = 0; player < PLAYERS; player++){
+        for(int game = 0; game < count; game++){
+            const PlayerMove& move = moves[player][game];
+            int playerX = x[player][game], playerY = y[player][game];
+
+            bool hasBomb = move.placesBomb();
+            bool hasAttack = move.attacks();
+            bool bombValid = !hasBomb ||
+                (bombCooldown[player][game] == 0 && isEmptyCell(game, move.bombX, move.bombY) &&
+                 std::abs(playerX - move.bombX) + std::abs(playerY - move.bombY) <= BOMB_RANGE);
+            bool attackValid = !hasAttack ||
+                std::abs(playerX - move.attackX) + std::abs(playerY - move.attackY) <= ATTACK_RANGE;
+
+            int newX = playerX + (move.dir == Direction::RIGHT) - (move.dir == Direction::LEFT);
+            int newY = playerY + (move.dir == Direction::DOWN) - (move.dir == Direction::UP);
+            bool moveValid = move.dir != Direction::NONE && bombValid && attackValid &&
+                             isEmptyCell(game, newX, newY);
+
+            bool moved = moveValid && !gameOver[game];
+            x[player][game] = moved ? newX : playerX;
+            y[player][game] = moved ? newY : playerY;
+
+            valid[player][game] = moveValid;
+            bombed[player][game] = hasBomb;
+            attacked[player][game] = hasAttack;
+        }
+    }
+
+    //Games where a move was invalid end here, games already over are not played
+    for(int game = 0; game < count; game++){
+        if(gameOver[game]){
+            valid[0][game] = false;
+            valid[1][game] = false;
+            continue;
+        }
+        if(valid[0][game] && valid[1][game]) continue;
+
+        gameOver[game] = true;
+        if(!valid[0][game] && !valid[1][game]){
+            endReason[game] = EndReason::BOTH_INVALID_MOVE;
+        }
+        else if(!valid[0][game]){
+            endReason[game] = EndReason::PLAYER1_INVALID_MOVE;
+        }
+        else{
+            endReason[game] = EndReason::PLAYER2_INVALID_MOVE;
+        }
+        currentTurn[game]++;
+        //Not played any further this turn
+        valid[0][game] = false;
+        valid[1][game] = false;
+    }
+
+    //From here valid[player][game] is set only for the games being played this turn
+    for(int player = 0; player < PLAYERS; player++){
+        for(int game = 0; game < count; game++){
+            bool played = valid[player][game];
+            lastMove[player][game] = played ? moves[player][game].dir : lastMove[player][game];
+
+            int attackCooldownLeft = std::max(0, attackCooldown[player][game] - 1);
+            int bombCooldownLeft = std::max(0, bombCooldown[player][game] - 1);
+            attackCooldown[player][game] = !played ? attackCooldown[player][game] :
+                attacked[player][game] ? ATTACK_COOLDOWN : attackCooldownLeft;
+            bombCooldown[player][game] = !played ? bombCooldown[player][game] :
+                bombed[player][game] ? BOMB_COOLDOWN : bombCooldownLeft;
+        }
+    }
+
+    //Bombs: crystals bombed by one player are collected by them, those bombed by both are destroyed
+    for(int game = 0; game < count; game++){
+        if(!valid[0][game] || (!bombed[0][game] && !bombed[1][game])) continue;
+
+        std::array<Bitboard<GRID_SIZE>, PLAYERS> explosionArea;
+        for(int player = 0; player < PLAYERS; player++){
+            if(bombed[player][game]){
+                const PlayerMove& move = moves[player][game];
+                explosionArea[player] = computeExplosionArea<StandardRules>(obstacles[game], move.bombX, move.bombY);
+            }
+        }
+        Bitboard<GRID_SIZE> hit1 = explosionArea[0] & crystals[game];
+        Bitboard<GRID_SIZE> hit2 = explosionArea[1] & crystals[game];
+        Bitboard<GRID_SIZE> shared = hit1 & hit2;
+
+        totalCrystals[game] -= shared.count();
+        crystalCount[0][game] += hit1.andNot(shared).count();
+        crystalCount[1][game] += hit2.andNot(shared).count();
+        crystals[game].andNot(explosionArea[0] | explosionArea[1]);
+    }
+
+    //Attacks, the attack area is the same as the explosion area
+    for(int player = 0; player < PLAYERS; player++){
+        for(int game = 0; game < count; game++){
+            if(!valid[player][game] || !attacked[player][game]) continue;
+
+            const PlayerMove& move = moves[player][game];
+            Bitboard<GRID_SIZE> attackArea = computeExplosionArea<StandardRules>(obstacles[game], move.attackX, move.attackY);
+            for(int enemy = 0; enemy < PLAYERS; enemy++){
+                if(enemy != player && attackArea.test(x[enemy][game], y[enemy][game])){
+                    hp[enemy][game]--;
+                }
+            }
+        }
+    }
+
+    for(int game = 0; game < count; game++){
+        if(!valid[0][game]) continue;
+
+        currentTurn[game]++;
+        std::array<int, PLAYERS> gameHP, gameCrystals;
+        for(int player = 0; player < PLAYERS; player++){
+            gameHP[player] = hp[player][game];
+            gameCrystals[player] = crystalCount[player][game];
+        }
+        EndReason reason = turnEndReason(gameHP, gameCrystals, totalCrystals[game], currentTurn[game], MAX_TURNS);
+        if(reason != EndReason::NONE){
+            gameOver[game] = true;
+            endReason[game] = reason;
+        }
+    }
+}
+
+//Getter functions
+int BatchGame::size() const{
+    return count;
+}
+
+char BatchGame::getCell(int game, int cellX, int cellY) const{
+    if(obstacles[game].test(cellX, cellY)) return '#';
+    if(crystals[game].test(cellX, cellY)) return 'C';
+    return '.';
+}
+
+int BatchGame::getTotalCrystals(int game) const{
+    return totalCrystals[game];
+}
+
+bool BatchGame::isGameOver(int game) const{
+    return gameOver[game];
+}
+
+int BatchGame::getCurrentTurn(int game) const{
+    return currentTurn[game];
+}
+
+int BatchGame::getX(int game, int player) const{
+    return x[player][game];
+}
+
+int BatchGame::getY(int game, int player) const{
+    return y[player][game];
+}
+
+int BatchGame::getHP(int game, int player) const{
+    return hp[player][game];
+}
+
+int BatchGame::getCrystals(int game, int player) const{
+    return crystalCount[player][game];
+}
+
+int BatchGame::getBombCooldown(int game, int player) const{
+    return bombCooldown[player][game];
+}
+
+int BatchGame::getAttackCooldown(int game, int player) const{
+    return attackCooldown[player][game];
+}
+
+Direction BatchGame::getLastMove(int game, int player) const{
+    return lastMove[player][game];
+}
+
+int BatchGame::getWinner(int game) const{
+    return gameOver[game] ? endReasonWinner(endReason[game]) : -1;
+}
+
+EndReason BatchGame::getEndReason(int game) const{
+    return endReason[game];
+}
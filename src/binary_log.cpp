@@ -0,0 +1,276 @@
+#include "../include/binary_log.h"
+#include "../include/log_writer.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace {
+
+constexpr std::string_view MAGIC {"CGLB"};
+constexpr char VERSION = 3;
+constexpr char FIRST_VERSION = 1; //Two players only
+constexpr char CPU_TIME_VERSION = 3; //First version logging the CPU time of the bots
+
+void putVarint(std::string& out, std::uint64_t value){
+    while(value >= 0x80){
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void putSigned(std::string& out, std::int64_t value){
+    //Zigzag, so small negative numbers stay small
+    putVarint(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void putUnsigned(std::string& out, std::int64_t value){
+    putVarint(out, static_cast<std::uint64_t>(value));
+}
+
+void putBitmap(std::string& out, const std::vector<bool>& bits){
+    for(std::size_t i = 0; i < bits.size(); i += 8){
+        unsigned char byte = 0;
+        for(std::size_t b = 0; b < 8 && i + b < bits.size(); ++b){
+            if(bits[i + b]) byte = static_cast<unsigned char>(byte | (1u << b));
+        }
+        out += static_cast<char>(byte);
+    }
+}
+
+} // namespace
+
+BinaryLogWriter::BinaryLogWriter(std::string logsPath)
+: path {logsPath}
+{
+}
+
+BinaryLogWriter::~BinaryLogWriter(){
+    if(file.is_open()){
+        finish();
+    }
+}
+
+void BinaryLogWriter::open(){
+    file.open(path, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "Error opening logs file: " << path << std::endl;
+        finished = true;
+        return;
+    }
+    file << MAGIC << VERSION;
+}
+
+void BinaryLogWriter::flushBuffer(){
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    buffer.clear();
+}
+
+void BinaryLogWriter::writeGrid(const std::string& grid, int players){
+    if(finished) return;
+    if(!file.is_open()){
+        open();
+        if(finished) return;
+    }
+
+    std::size_t size = grid.find('\n');
+    std::vector<bool> obstacles(size * size), crystals(size * size);
+    std::vector<std::size_t> markers(static_cast<std::size_t>(players));
+
+    std::size_t cell = 0;
+    for(char c : grid){
+        if(c == '\n') continue;
+        if(c == '#') obstacles[cell] = true;
+        else if(c == 'C') crystals[cell] = true;
+        else if(c >= '1' && c < '1' + players) markers[static_cast<std::size_t>(c - '1')] = cell + 1;
+        cell++;
+    }
+
+    buffer += 'G';
+    putVarint(buffer, size);
+    putUnsigned(buffer, players);
+    putBitmap(buffer, obstacles);
+    putBitmap(buffer, crystals);
+    for(std::size_t marker : markers){
+        putVarint(buffer, marker);
+    }
+    flushBuffer();
+}
+
+void BinaryLogWriter::writeTurn(const TurnRecord& turn){
+    if(finished) return;
+    if(!file.is_open()){
+        open();
+        if(finished) return;
+    }
+
+    buffer += 'T';
+    putUnsigned(buffer, turn.turn);
+    previous.players.resize(turn.players.size());
+    for(std::size_t i = 0; i < turn.players.size(); ++i){
+        const PlayerRecord& player = turn.players[i];
+        const PlayerRecord& before = previous.players[i];
+
+        buffer += static_cast<char>((player.readError ? 1 : 0) | (static_cast<int>(player.move.dir) << 1) |
+                                    (player.eliminated ? 1 << 4 : 0));
+        putSigned(buffer, player.move.bombX);
+        putSigned(buffer, player.move.bombY);
+        putSigned(buffer, player.move.attackX);
+        putSigned(buffer, player.move.attackY);
+        putSigned(buffer, player.x - before.x);
+        putSigned(buffer, player.y - before.y);
+        putSigned(buffer, player.hp - before.hp);
+        putSigned(buffer, player.crystals - before.crystals);
+        putUnsigned(buffer, player.attackCooldown);
+        putUnsigned(buffer, player.bombCooldown);
+        putUnsigned(buffer, player.responseTime.count());
+        putUnsigned(buffer, player.cpuTime.count());
+        putSigned(buffer, player.writeSyscalls);
+    }
+    buffer += static_cast<char>(turn.gameOver);
+    if(turn.gameOver){
+        putSigned(buffer, turn.winner);
+        putVarint(buffer, turn.endReason.size());
+        buffer += turn.endReason;
+    }
+    flushBuffer();
+    previous = turn;
+}
+
+void BinaryLogWriter::finish(){
+    if(finished){
+        return;
+    }
+    finished = true;
+    if(file.is_open()){
+        file << 'F';
+        file.close();
+    }
+}
+
+BinaryLogReader::BinaryLogReader(std::istream& input)
+: in {input}
+{
+    char header[5] {};
+    valid = static_cast<bool>(in.read(header, sizeof(header))) &&
+            std::string_view(header, 4) == MAGIC && header[4] >= FIRST_VERSION && header[4] <= VERSION;
+    version = header[4];
+}
+
+bool BinaryLogReader::isValid() const{
+    return valid;
+}
+
+int BinaryLogReader::getPlayerCount() const{
+    return players;
+}
+
+bool BinaryLogReader::readVarint(std::uint64_t& value){
+    value = 0;
+    for(int shift = 0; shift < 64; shift += 7){
+        int c = in.get();
+        if(c == EOF) return false;
+        value |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+        if(!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool BinaryLogReader::readSigned(int& value){
+    std::uint64_t raw;
+    if(!readVarint(raw)) return false;
+    value = static_cast<int>(static_cast<std::int64_t>(raw >> 1) ^ -static_cast<std::int64_t>(raw & 1));
+    return true;
+}
+
+bool BinaryLogReader::readUnsigned(int& value){
+    std::uint64_t raw;
+    if(!readVarint(raw)) return false;
+    value = static_cast<int>(raw);
+    return true;
+}
+
+BinaryLogReader::Entry BinaryLogReader::next(std::string& grid, TurnRecord& turn){
+    if(!valid) return Entry::END;
+
+    int tag = in.get();
+    if(tag == 'G'){
+        int size;
+        if(!readUnsigned(size)) return Entry::END;
+        if(version > FIRST_VERSION && !readUnsigned(players)) return Entry::END;
+        std::size_t cells = static_cast<std::size_t>(size * size);
+        std::string bitmaps((cells + 7) / 8 * 2, '\0');
+        if(!in.read(bitmaps.data(), static_cast<std::streamsize>(bitmaps.size()))) return Entry::END;
+        std::vector<int> markers(static_cast<std::size_t>(players));
+        for(int& marker : markers){
+            if(!readUnsigned(marker)) return Entry::END;
+        }
+
+        auto bit = [&](std::size_t offset, std::size_t i){
+            return (static_cast<unsigned char>(bitmaps[offset + i / 8]) >> (i % 8)) & 1;
+        };
+        grid.clear();
+        for(std::size_t i = 0; i < cells; ++i){
+            //The first player on a cell is drawn, as in Engine::getGridString()
+            auto marker = std::find(markers.begin(), markers.end(), static_cast<int>(i + 1));
+            if(marker != markers.end()) grid += static_cast<char>('1' + (marker - markers.begin()));
+            else if(bit(0, i)) grid += '#';
+            else if(bit((cells + 7) / 8, i)) grid += 'C';
+            else grid += '.';
+            if((i + 1) % static_cast<std::size_t>(size) == 0) grid += '\n';
+        }
+        return Entry::GRID;
+    }
+    if(tag != 'T'){
+        return Entry::END; //'F' or the log was cut short
+    }
+
+    if(!readUnsigned(turn.turn)) return Entry::END;
+    turn.players.resize(static_cast<std::size_t>(players));
+    previous.players.resize(turn.players.size());
+    for(std::size_t i = 0; i < turn.players.size(); ++i){
+        PlayerRecord& player = turn.players[i];
+        const PlayerRecord& before = previous.players[i];
+
+        int flags = in.get();
+        if(flags == EOF) return Entry::END;
+        player.readError = flags & 1;
+        player.move.dir = static_cast<Direction>((flags >> 1) & 7);
+        player.eliminated = (flags >> 4) & 1;
+
+        int dx, dy, dhp, dcrystals, responseTime, cpuTime = 0;
+        if(!readSigned(player.move.bombX) || !readSigned(player.move.bombY) ||
+           !readSigned(player.move.attackX) || !readSigned(player.move.attackY) ||
+           !readSigned(dx) || !readSigned(dy) || !readSigned(dhp) || !readSigned(dcrystals) ||
+           !readUnsigned(player.attackCooldown) || !readUnsigned(player.bombCooldown) ||
+           !readUnsigned(responseTime) || (version >= CPU_TIME_VERSION && !readUnsigned(cpuTime)) ||
+           !readSigned(player.writeSyscalls)){
+            return Entry::END;
+        }
+        player.x = before.x + dx;
+        player.y = before.y + dy;
+        player.hp = before.hp + dhp;
+        player.crystals = before.crystals + dcrystals;
+        player.responseTime = std::chrono::microseconds(responseTime);
+        player.cpuTime = std::chrono::microseconds(cpuTime);
+    }
+
+    int gameOver = in.get();
+    if(gameOver == EOF) return Entry::END;
+    turn.gameOver = gameOver != 0;
+    turn.endReason.clear();
+    if(turn.gameOver){
+        int length;
+        if(!readSigned(turn.winner) || !readUnsigned(length)) return Entry::END;
+        turn.endReason.resize(static_cast<std::size_t>(length));
+        if(!in.read(turn.endReason.data(), length)) return Entry::END;
+    }
+    previous = turn;
+    return Entry::TURN;
+}
@@ -0,0 +1,62 @@
+#include "../include/bot_pool.h"
+
+#include <cstdio>
+
+#include <fcntl.h>
+
+namespace {
+
+//Launches `path`, with SHM_ENV set to the name of `channel` if there is one
+bp::child launch(const std::string& path, bp::async_pipe& out, bp::pipe& in, const ShmChannel* channel){
+    if(channel){
+        return bp::child(path, bp::std_out > out, bp::std_in < in, bp::env[SHM_ENV] = channel->getName());
+    }
+    return bp::child(path, bp::std_out > out, bp::std_in < in);
+}
+
+} // namespace
+
+BotProcess::BotProcess(const std::string& executable, asio::io_context& ctx, bool sharedMemory)
+    : path(executable), out(ctx), channel(sharedMemory ? std::make_unique<ShmChannel>() : nullptr),
+      child(launch(executable, out, in, channel.get())), cpuClock(processCpuClock(child.id())) {
+    //Observations are written without blocking, a bot that does not read them is not waited for (see writePipesDeadline())
+    int flags = fcntl(in.native_sink(), F_GETFL);
+    if(flags == -1 || fcntl(in.native_sink(), F_SETFL, flags | O_NONBLOCK) == -1){
+        perror("fcntl");
+    }
+}
+
+void BotProcess::stop(){
+    child.terminate();
+    child.wait();
+}
+
+BotPool::~BotPool(){
+    for(auto& [path, bots] : idle){
+        for(std::unique_ptr<BotProcess>& bot : bots){
+            bot->stop();
+        }
+    }
+}
+
+asio::io_context& BotPool::context(){
+    return ctx;
+}
+
+std::unique_ptr<BotProcess> BotPool::acquire(const std::string& path, bool sharedMemory){
+    std::vector<std::unique_ptr<BotProcess>>& bots = idle[{path, sharedMemory}];
+    while(!bots.empty()){
+        std::unique_ptr<BotProcess> bot = std::move(bots.back());
+        bots.pop_back();
+        if(bot->child.running()){
+            return bot;
+        }
+        //It exited while it was waiting
+        bot->stop();
+    }
+    return std::make_unique<BotProcess>(path, ctx, sharedMemory);
+}
+
+void BotPool::release(std::unique_ptr<BotProcess> bot){
+    idle[{bot->path, bot->channel != nullptr}].push_back(std::move(bot));
+}
@@ -1,767 +1,671 @@
 #include "../include/engine.h"
+#include "../include/game.h"
 #include "../include/nlohmann_json.hpp"
 #include <iostream>
-#include <random>
 #include <string>
 #include <string_view>
 #include <sstream>
+#include <charconv>
+#include <system_error>
 #include <array>
 #include <utility>
-#include <set>
 #include <fstream>
 #include <cassert>
-
-Engine::Engine()
-: logsFilePath {"logs.json"}
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+template <typename Rules>
+BasicEngine<Rules>::BasicEngine()
+: game {static_cast<unsigned>(std::time(nullptr))},
+  logs {makeLogWriter("logs.json")}
 {
-    rng.seed(
-        static_cast<unsigned>(std::time(nullptr))
-    );
-    initialiseGrid();
 }
 
-Engine::Engine(unsigned seed)
-: logsFilePath {"logs.json"}
+template <typename Rules>
+BasicEngine<Rules>::BasicEngine(unsigned seed)
+: game {seed},
+  logs {makeLogWriter("logs.json")}
 {
-    rng.seed(seed);
-    initialiseGrid();
 }
 
-Engine::Engine(std::string path)
-: logsFilePath {path}
+template <typename Rules>
+BasicEngine<Rules>::BasicEngine(std::string path)
+: game {static_cast<unsigned>(std::time(nullptr))},
+  logs {makeLogWriter(path)}
 {
-    rng.seed(
-        static_cast<unsigned>(std::time(nullptr))
-    );
-    initialiseGrid();
 }
 
-Engine::Engine(std::string path,
-       unsigned seed)
-       : logsFilePath {path}
+template <typename Rules>
+BasicEngine<Rules>::BasicEngine(std::string path,
+       unsigned seed,
+       int players)
+       : game {seed, players},
+         logs {makeLogWriter(path)}
 {
-    rng.seed(seed);
-    initialiseGrid();
 }
 
-bool Engine::isValidPosition(int x, int y) const {
-    return x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE;
-}
+namespace {
 
-bool Engine::isEmptyCell(int x, int y) const {
-    return isValidPosition(x, y) && grid[y][x] == '.';
+bool isSpace(char c){
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
 }
 
-bool Engine::isCrystalCell(int x, int y) const {
-    return isValidPosition(x, y) && grid[y][x] == 'C';
+//Removes the next whitespace separated token from the front of `input` and returns it.
+//Returns an empty view if there are no tokens left.
+std::string_view nextToken(std::string_view& input){
+    std::size_t start = 0;
+    while(start < input.size() && isSpace(input[start])) start++;
+    std::size_t end = start;
+    while(end < input.size() && !isSpace(input[end])) end++;
+
+    std::string_view token = input.substr(start, end - start);
+    input.remove_prefix(end);
+    return token;
 }
 
-bool Engine::isObstacleCell(int x, int y) const {
-    return isValidPosition(x, y) && grid[y][x] == '#';
+bool nextInt(std::string_view& input, int& value){
+    std::string_view token = nextToken(input);
+    auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return !token.empty() && ec == std::errc() && ptr == token.data() + token.size();
 }
 
-int Engine::manhattanDistance(int x1, int y1, int x2, int y2) const {
-    return std::abs(x1 - x2) + std::abs(y1 - y2);
+void appendInt32(std::string& out, int value){
+    std::int32_t field = value;
+    char bytes[sizeof(field)];
+    std::memcpy(bytes, &field, sizeof(field));
+    out.append(bytes, sizeof(field));
 }
 
-void Engine::initialiseGrid(){
-    for (int i = 0; i < GRID_SIZE; i++)
-    {
-        grid[i].fill('.');
-    }
-
-    std::uniform_real_distribution<float> disMult(0, 0.1f);
-    float obstacleMultiplier = disMult(rng);
-
-    //Randomly place obstacles in 0% - 10% of the grid
-    int obstacleCount = static_cast<int>(GRID_SIZE * GRID_SIZE * obstacleMultiplier);
-
-    std::uniform_int_distribution<int> disGrid(0, GRID_SIZE - 1);
-    int x, y;
-
-    for (int i = 0; i < obstacleCount; i++)
-    {
-        do{
-            x = disGrid(rng);
-            y = disGrid(rng);
-        } while (!isEmptyCell(x, y));
-
-        grid[y][x] = '#';
-    }
-
-    std::uniform_int_distribution<int> disCrystal(0, 9);
-    totalCrystals = MIN_CRYSTALS  + disCrystal(rng);
-    if(totalCrystals % 2 == 0){
-        totalCrystals++; //Ensure odd number of crystals
-    }
-
-    //Randomly place crystals in the grid
-    for (int i = 0; i < totalCrystals; i++)
-    {
-        do{
-            x = disGrid(rng);
-            y = disGrid(rng);
-        } while (!isEmptyCell(x, y));
-
-        grid[y][x] = 'C';
-    }
-
-    //Place players in opposite halves (left/right) of the grid
-    std::uniform_int_distribution<int> disGridHalf(0, GRID_SIZE / 2 - 1);
-    do {
-        player1X = disGridHalf(rng);
-        player1Y = disGridHalf(rng);
-    } while (!isEmptyCell(player1X, player1Y));
-    
-    do {
-        player2X = (GRID_SIZE / 2) + disGridHalf(rng);
-        player2Y = (GRID_SIZE / 2) + disGridHalf(rng);
-    } while (!isEmptyCell(player2X, player2Y));
+//The `index`th 32-bit int of `frame`, which must be long enough
+int frameInt(std::string_view frame, std::size_t index){
+    std::int32_t field;
+    std::memcpy(&field, frame.data() + index * sizeof(field), sizeof(field));
+    return field;
 }
 
-//Returns true if the input format is valid, false otherwise.
-bool Engine::parseMove(const std::string_view input, PlayerMove& move) const {
-        std::stringstream ss(input.data());
+} // namespace
 
-        std::string moveStr, attackStr, bombStr;
-        
-        if(!(ss >> moveStr) || moveStr !=  "MOVE"){
+//Returns true if the input format is valid, false otherwise.
+template <typename Rules>
+bool BasicEngine<Rules>::parseMove(std::string_view input, PlayerMove& move) {
+        if(nextToken(input) != "MOVE"){
             return false;
         }
 
-        if(!(ss >> move.dir) || 
-        (move.dir != "UP" && move.dir != "DOWN" &&
-         move.dir != "LEFT" && move.dir != "RIGHT")){
-            return false;
-        }
+        std::string_view dir = nextToken(input);
+        if(dir == "UP") move.dir = Direction::UP;
+        else if(dir == "DOWN") move.dir = Direction::DOWN;
+        else if(dir == "LEFT") move.dir = Direction::LEFT;
+        else if(dir == "RIGHT") move.dir = Direction::RIGHT;
+        else return false;
 
-        if(!(ss >> bombStr) || bombStr != "BOMB"){
+        if(nextToken(input) != "BOMB"){
             return false;
         }
-        if(!(ss >> move.bombX) || !(ss >> move.bombY)){
+        if(!nextInt(input, move.bombX) || !nextInt(input, move.bombY)){
             return false;
         }
-        if(!isValidPosition(move.bombX, move.bombY)){
+        if(!BasicGame<Rules>::isValidPosition(move.bombX, move.bombY)){
             if(!(move.bombX == -1 && move.bombY == -1)){ //Bomb not used
                 return false;
             }
         }
 
-        if(!(ss >> attackStr) || attackStr != "ATTACK"){
+        if(nextToken(input) != "ATTACK"){
             return false;
         }
-        if(!(ss >> move.attackX) || !(ss >> move.attackY)){
+        if(!nextInt(input, move.attackX) || !nextInt(input, move.attackY)){
             return false;
         }
-        if(!isValidPosition(move.attackX, move.attackY)){
+        if(!BasicGame<Rules>::isValidPosition(move.attackX, move.attackY)){
             if(!(move.attackX == -1 && move.attackY == -1)){ //Attack not used
                 return false;
             }
         }
 
-        std::string remaining;
-        if(ss >> remaining){
+        if(!nextToken(input).empty()){
             return false; //Extra input
         }
         return true;
 }
 
-//Move the player in the specified direction
-//Returns true if the move is valid, false otherwise.
-bool Engine::movePlayer(int player, std::string_view move) {
-    //Player 1 is 0, Player 2 is 1
-    int& playerX = (player == 0) ? player1X : player2X;
-    int& playerY = (player == 0) ? player1Y : player2Y;
-
-    int newX = playerX, newY = playerY;
-
-    if (move == "UP") newY--;
-    else if (move == "DOWN") newY++;
-    else if (move == "LEFT") newX--;
-    else if (move == "RIGHT") newX++;
-
-    if (!isValidPosition(newX, newY) || !isEmptyCell(newX, newY)) {
-        return false; // Invalid move
-    }
-    playerX = newX;
-    playerY = newY;
-    return true;
+template <typename Rules>
+bool BasicEngine<Rules>::decodeMove(std::string_view frame, PlayerMove& move){
+    if(frame.size() != 5 * sizeof(std::int32_t)){
+        return false;
+    }
+    int dir = frameInt(frame, 0);
+    if(dir < static_cast<int>(Direction::UP) || dir > static_cast<int>(Direction::RIGHT)){
+        return false;
+    }
+    move.dir = static_cast<Direction>(dir);
+    move.bombX = frameInt(frame, 1);
+    move.bombY = frameInt(frame, 2);
+    move.attackX = frameInt(frame, 3);
+    move.attackY = frameInt(frame, 4);
+
+    //Positions must be on the grid or both -1 (not used), as in parseMove()
+    auto isUnusedOrValid = [](int x, int y){
+        return BasicGame<Rules>::isValidPosition(x, y) || (x == -1 && y == -1);
+    };
+    return isUnusedOrValid(move.bombX, move.bombY) && isUnusedOrValid(move.attackX, move.attackY);
 }
 
-void Engine::getExplosionArea(int x, int y, std::set<std::pair<int, int>>& explosionArea) const{
-    explosionArea.emplace(x, y); //Add the cell where the bomb is placed
-
-    int dx[4] = {1, -1, 0, 0};
-    int dy[4] = {0, 0, 1, -1};
-
-    for (int dir = 0; dir < 4; dir++)
-    {
-        for (int dist = 1; dist <= BOMB_RANGE-1; dist++)
-        {
-            int newX = x + dx[dir] * dist;
-            int newY = y + dy[dir] * dist;
-
-            if (!isValidPosition(newX, newY) || isObstacleCell(newX, newY)) {
-                break; //Stop if out of bounds or obstacle in this direction
-            }
-            explosionArea.emplace(newX, newY);
-        }   
+template <typename Rules>
+int BasicEngine<Rules>::takeProtocolRequest(std::string_view& input){
+    std::size_t request = input.rfind("PROTOCOL");
+    if(request == std::string_view::npos){
+        return 0;
     }
-}
-
-void Engine::processTurn(std::string_view player1Input, std::string_view player2Input)
-{
-    PlayerMove player1Move, player2Move;
-
-    if (!parseMove(player1Input, player1Move))
-    {
-        player1Lost = true;
-    }
-    if (!parseMove(player2Input, player2Move))
-    {
-        player2Lost = true;
+    std::string_view version = input.substr(request + std::string_view("PROTOCOL").size());
+    int value;
+    if(!nextInt(version, value) || !nextToken(version).empty()){
+        return 0;
     }
+    input = input.substr(0, request);
+    return value;
+}
 
-    bool player1Bombed{true}, player2Bombed{true};
-    if (!player1Lost && player1Move.bombX == -1 && player1Move.bombY == -1)
-    {
-        player1Bombed = false;
+template <typename Rules>
+bool BasicEngine<Rules>::takeMultiGameRequest(std::string_view& input){
+    constexpr std::string_view request = "MULTIGAME";
+    std::size_t end = input.find_last_not_of(" \r");
+    if(end == std::string_view::npos){
+        return false;
     }
-    if (!player2Lost && player2Move.bombX == -1 && player2Move.bombY == -1)
-    {
-        player2Bombed = false;
+    std::string_view rest = input.substr(0, end + 1);
+    if(!rest.ends_with(request)){
+        return false;
     }
+    input = rest.substr(0, rest.size() - request.size());
+    return true;
+}
 
-    if (!player1Lost && player1Bombed)
-    {
-        // Check if BOMB is placed on a non-empty cell
-        if (!isEmptyCell(player1Move.bombX, player1Move.bombY))
-        {
-            player1Lost = true;
-        }
-        // Check if BOMB is before cooldown is over
-        if (player1BombCooldown > 0)
-        {
-            player1Lost = true;
-        }
-    }
-    if (!player2Lost && player2Bombed)
+template <typename Rules>
+void BasicEngine<Rules>::processTurn(const std::array<std::string_view, MAX_PLAYERS>& inputs)
+{
+    //A move that cannot be parsed is played with no direction, which loses the game,
+    //but the parsed fields are still logged. Eliminated players are logged with no move.
+    std::array<PlayerMove, MAX_PLAYERS> moves, played;
+    for (int i = 0; i < game.getPlayerCount(); i++)
     {
-        if (!isEmptyCell(player2Move.bombX, player2Move.bombY))
+        if (isEliminated(i))
         {
-            player2Lost = true;
+            moves[i] = PlayerMove{Direction::NONE, -1, -1, -1, -1};
+            continue;
         }
-        if (player2BombCooldown > 0)
+        std::string_view input = inputs[i];
+        if (plugins[i])
         {
-            player2Lost = true;
+            if (decodeMove(input, moves[i]))
+            {
+                played[i] = moves[i];
+            }
+            continue;
         }
-    }
-
-    // Check if BOMB is placed within range
-    if (!player1Lost && (player1Move.bombX != -1 && player1Move.bombY != -1))
-    {
-        if (manhattanDistance(player1X, player1Y,
-                              player1Move.bombX, player1Move.bombY) > BOMB_RANGE)
+        if (getCurrentTurn() == 0)
         {
-            player1Lost = true;
-        }
-    }
-    if (!player2Lost && (player2Move.bombX != -1 && player2Move.bombY != -1))
-    {
-        if (manhattanDistance(player2X, player2Y,
-                              player2Move.bombX, player2Move.bombY) > BOMB_RANGE)
-        {
-            player2Lost = true;
+            int version = takeProtocolRequest(input);
+            if (version == DELTA_PROTOCOL || version == BINARY_PROTOCOL ||
+                (version == SHM_PROTOCOL && sharedMemoryOffered[i]))
+            {
+                protocols[i] = version;
+            }
+            multiGame[i] = takeMultiGameRequest(input);
         }
-    }
-
-    bool player1Attacked{true}, player2Attacked{true};
-    if (!player1Lost && player1Move.attackX == -1 && player1Move.attackY == -1)
-    {
-        player1Attacked = false;
-    }
-    if (!player2Lost && player2Move.attackX == -1 && player2Move.attackY == -1)
-    {
-        player2Attacked = false;
-    }
-
-    // Check if ATTACK is placed within range
-    if (!player1Lost && player1Attacked)
-    {
-        if (manhattanDistance(player1X, player1Y,
-                              player1Move.attackX, player1Move.attackY) > ATTACK_RANGE)
+        else if (usesBinaryProtocol(i))
         {
-            player1Lost = true;
+            if (decodeMove(input, moves[i]))
+            {
+                played[i] = moves[i];
+            }
+            continue;
         }
-    }
-    if (!player2Lost && player2Attacked)
-    {
-        if (manhattanDistance(player2X, player2Y,
-                              player2Move.attackX, player2Move.attackY) > ATTACK_RANGE)
+        if (parseMove(input, moves[i]))
         {
-            player2Lost = true;
+            played[i] = moves[i];
         }
     }
 
-    if (!player1Lost && !movePlayer(0, player1Move.dir))
+    //Crystals are the only cells that change after the map is generated
+    if constexpr (Rules::SPARSE)
     {
-        player1Lost = true;
+        game.playTurn(played);
+        changedCells = game.getChangedCells();
     }
-    if (!player2Lost && !movePlayer(1, player2Move.dir))
+    else
     {
-        player2Lost = true;
+        Bitboard<GRID_SIZE> crystals = game.getCrystalCells();
+        game.playTurn(played);
+        changedCells.clear();
+        crystals.andNot(game.getCrystalCells()).forEach([this](int x, int y){
+            changedCells.emplace_back(x, y);
+        });
     }
 
-    // All moves have been verified for validity
-    if (player1Lost || player2Lost)
+    logTurn(moves);
+    outputReadErrors = {}; //Of the players eliminated before this turn in a free-for-all
+    if (game.isGameOver())
     {
-        gameOver = true;
-        if (player1Lost && player2Lost)
-        {
-            endReason = "Tie: Both players sent an invalid move";
-        }
-        else if (player1Lost)
-        {
-            endReason = "Player 2 wins as Player 1 sent an invalid move";
-        }
-        else
-        {
-            endReason = "Player 1 wins as Player 2 sent an invalid move";
-        }
-        currentTurn++;
-        logTurn(player1Move, player2Move);
         writeLogs();
-        return;
-    }
-
-    // Both players have made valid moves and moved successfully
-
-    // Store the last moves so it can be sent in the next turn
-    player1LastMove = player1Move.dir;
-    player2LastMove = player2Move.dir;
-
-    // Update cooldowns
-    player1AttackCooldown = (player1Attacked) ? ATTACK_COOLDOWN : std::max(0, player1AttackCooldown - 1);
-    player2AttackCooldown = (player2Attacked) ? ATTACK_COOLDOWN : std::max(0, player2AttackCooldown - 1);
-    player1BombCooldown = (player1Bombed) ? BOMB_COOLDOWN : std::max(0, player1BombCooldown - 1);
-    player2BombCooldown = (player2Bombed) ? BOMB_COOLDOWN : std::max(0, player2BombCooldown - 1);
-
-    // Calculate cells affected by the bombs of both players
-    std::set<std::pair<int, int>> explosionArea1;
-    std::set<std::pair<int, int>> explosionArea2;
-
-    if (player1Bombed)
-    {
-        getExplosionArea(player1Move.bombX, player1Move.bombY, explosionArea1);
-    }
-    if (player2Bombed)
-    {
-        getExplosionArea(player2Move.bombX, player2Move.bombY, explosionArea2);
     }
+}
 
-    collectCrystals(0, explosionArea1, explosionArea2);
-    collectCrystals(1, explosionArea2, explosionArea1);
-
-    std::set<std::pair<int, int>> attackArea1;
-    std::set<std::pair<int, int>> attackArea2;
-
-    if (player1Attacked)
-    {
-        // Attack area is the same as explosion area
-        getExplosionArea(player1Move.attackX, player1Move.attackY, attackArea1);
-    }
-    if (player2Attacked)
-    {
-        // Attack area is the same as explosion area
-        getExplosionArea(player2Move.attackX, player2Move.attackY, attackArea2);
+//Used if there is an error while reading input from the players
+//This is not for invalid input but rather errors in the input reading process itself
+template <typename Rules>
+void BasicEngine<Rules>::outputReadError(const std::array<bool, MAX_PLAYERS>& readErrors){
+    for(int i = 0; i < game.getPlayerCount(); i++){
+        outputReadErrors[i] = outputReadErrors[i] || readErrors[i];
     }
 
-    if (attackArea1.count({player2X, player2Y}))
-    {
-        player2HP--;
-    }
-    if (attackArea2.count({player1X, player1Y}))
-    {
-        player1HP--;
+    game.forfeit(readErrors);
+    if(!game.isGameOver() && game.getPlayerCount() > 2){
+        //The others play the turn, processTurn() logs it with the errors
+        return;
     }
+    changedCells.clear();
 
-    // Crystals have been collected and players have attacked
-    // Now we need to check if game is over
-    currentTurn++;
-    if (checkGameOver())
+    //The turn is not played, its log has "ERROR" as the moves of the players at fault
+    //and no move for the others.
+    std::array<PlayerMove, MAX_PLAYERS> moves;
+    moves.fill(PlayerMove{Direction::NONE, -1, -1, -1, -1});
+    logTurn(moves);
+    outputReadErrors = {};
+    if (game.isGameOver())
     {
-        logTurn(player1Move, player2Move);
         writeLogs();
-        return;
     }
-    logTurn(player1Move, player2Move);
 }
 
-//To be used when both players have provided correct input and already moved
-//gameOver must not be set to true before checking this
-bool Engine::checkGameOver(){
-    if(gameOver) return true;
-
-    //Check if any player has lost all HP
-    if(player1HP <= 0){
-        assert(player1HP == 0);
-        gameOver = true;
-        player1Lost = true;
-    }
-    else if(player2HP <= 0){
-        assert(player1HP == 0);
-        gameOver = true;
-        player2Lost = true;
-    }
-
-    if(player1Lost && player2Lost){
-        gameOver = true;
-        if(player1Crystals > player2Crystals){
-            endReason = "Player 1 wins as both players have died and Player 1 has more crystals";
-        }
-        else if(player2Crystals > player1Crystals){
-            endReason = "Player 2 wins as both players have died and Player 2 has more crystals";
-        }
-        else{
-            endReason = "Tie: Both players lost all HP and have the same number of crystals";
-        }
-    }
-    else if(player1Lost){
-        gameOver = true;
-        endReason = "Player 2 wins as Player 1 lost all HP";
-    }
-    else if(player2Lost){
-        gameOver = true;
-        endReason = "Player 1 wins as Player 2 lost all HP";
-    }
-    if(gameOver) return true;
-
-    //Check if no crystals are left
-    if(totalCrystals <= 0){
-        assert(totalCrystals == 0);
-        gameOver = true;
-        if(player1Crystals > player2Crystals){
-            player2Lost = true;
-            endReason = "Player 1 wins as all crystals have been collected and Player 1 has more crystals";
-        }
-        else if(player2Crystals > player1Crystals){
-            player1Lost = true;
-            endReason = "Player 2 wins as all crystals have been collected and Player 2 has more crystals";
-        }
-        else{
-            //Crystals are equal so check HP
-            if(player1HP > player2HP){
-                player2Lost = true;
-                endReason = "Player 1 wins as all crystals have been collected and Player 1 has more HP";
-            }
-            else if(player2HP > player1HP){
-                player1Lost = true;
-                endReason = "Player 2 wins as all crystals have been collected and Player 2 has more HP";
-            }
-            else{
-                player1Lost = true;
-                player2Lost = true;
-                endReason = "Tie: All crystals have been collected and both players have the same HP";
-            }
-        }
-        return true;
-    }
-
-    //Check if max moves have been played
-    if(currentTurn >= MAX_TURNS){
-        gameOver = true;
-        if(player1Crystals > player2Crystals){
-            player2Lost = true;
-            endReason = std::string("Player 1 wins as ") +
-                        std::to_string(MAX_TURNS) +
-                        std::string(" moves have been played and Player 1 has more crystals");
-        }
-        else if(player2Crystals > player1Crystals){
-            player1Lost = true;
-            endReason = std::string("Player 1 wins as ") +
-                        std::to_string(MAX_TURNS) +
-                        std::string(" moves have been played and Player 2 has more crystals");        }
-        else{
-            //Crystals are equal so check HP
-            if(player1HP > player2HP){
-                player2Lost = true;
-                endReason = std::string("Player 1 wins as ") +
-                            std::to_string(MAX_TURNS) +
-                            std::string(" moves have been played, both players have the same crystals and Player 1 has more HP");
-            }
-            else if(player2HP > player1HP){
-                player1Lost = true;
-                endReason = std::string("Player 1 wins as ") +
-                            std::to_string(MAX_TURNS) +
-                            std::string(" moves have been played, both players have the same crystals and Player 2 has more HP");
-            }
-            else{
-                player1Lost = true;
-                player2Lost = true;
-                endReason = std::string("Tie: ") +
-                            std::to_string(MAX_TURNS) +
-                            std::string(" moves have been played and both players have the same crystals and HP");
-            }
-        }
-        return true;
-    }
-
-    return false; //Game is still ongoing
+template <typename Rules>
+void BasicEngine<Rules>::setResponseTimes(const std::array<std::chrono::microseconds, MAX_PLAYERS>& times){
+    responseTimes = times;
 }
 
-//Used if there is an error while reading input from the players
-//This is not for invalid input but rather errors in the input reading process itself
-void Engine::outputReadError(bool player1Error, bool player2Error){
-    player1OutputReadError = player1Error;
-    player2OutputReadError = player2Error;
-
-    assert(player1Error || player2Error);
-
-    if(player1Error) player1Lost = true;
-    if(player2Error) player2Lost = true;
-    gameOver = true;
-
-    if(player1Error && player2Error){
-        endReason = "Tie: Error encountered while reading input from both players";
-    }
-    else if(player1Error){
-        endReason = "Player 2 wins as error encountered while reading input from Player 1";
-    }
-    else{
-        endReason = "Player 1 wins as error encountered while reading input from Player 2";
-    }
+template <typename Rules>
+void BasicEngine<Rules>::setCpuTimes(const std::array<std::chrono::microseconds, MAX_PLAYERS>& times){
+    cpuTimes = times;
 }
 
-void Engine::collectCrystals(int player,
-    std::set<std::pair<int, int>>& explosionArea,
-    std::set<std::pair<int, int>>& explosionArea2){
-
-    int& playerCrystals = (player == 0) ? player1Crystals : player2Crystals;
+template <typename Rules>
+void BasicEngine<Rules>::setWriteSyscalls(const std::array<int, MAX_PLAYERS>& syscalls){
+    writeSyscalls = syscalls;
+}
 
-    for(const auto& [x, y] : explosionArea){
-        if(isCrystalCell(x, y)){
-            if(explosionArea2.count({x, y})){
-                //Both players bombed the same crystal
-                grid[y][x] = '.'; //Remove crystal from grid
-                totalCrystals--;
-            }
-            else{
-                //Player collects the crystal
-                playerCrystals++;
-                grid[y][x] = '.'; //Remove crystal from grid
-            }
-        }
+template <typename Rules>
+char BasicEngine<Rules>::cellMarker(int x, int y) const{
+    for (int i = 0; i < game.getPlayerCount(); i++)
+    {
+        if (x == game.getX(i) && y == game.getY(i))
+            return static_cast<char>('1' + i);
     }
+    return game.getCell(x, y);
 }
 
-std::string Engine::getGridString() const{
+template <typename Rules>
+std::string BasicEngine<Rules>::getGridString() const{
     std::string gridStr;
     for (int y = 0; y < GRID_SIZE; y++)
     {
         for (int x = 0; x < GRID_SIZE; x++)
         {
-            if (x == player1X && y == player1Y)
-                gridStr += '1';
-            else if (x == player2X && y == player2Y)
-                gridStr += '2';
-            else
-                gridStr += grid[y][x];
+            gridStr += cellMarker(x, y);
         }
         gridStr += '\n';
     }
     return gridStr;
 }
 
-std::string Engine::getGridStringPlayersHidden() const{
+template <typename Rules>
+std::string BasicEngine<Rules>::getGridStringPlayersHidden() const{
     std::string gridStr;
     for (int y = 0; y < GRID_SIZE; y++)
     {
         for (int x = 0; x < GRID_SIZE; x++)
         {
-            gridStr += grid[y][x];
+            gridStr += game.getCell(x, y);
         }
         gridStr += '\n';
     }
     return gridStr;
 }
 
-void Engine::printGrid() const {
+template <typename Rules>
+void BasicEngine<Rules>::printGrid() const {
+    if constexpr (Rules::SPARSE)
+    {
+        //Too large to print every turn, only the players are shown
+        for (int i = 0; i < game.getPlayerCount(); i++)
+        {
+            std::cout << "Player " << i + 1 << " at " << game.getX(i) << ' ' << game.getY(i) << '\n';
+        }
+        return;
+    }
     for (int y = 0; y < GRID_SIZE; y++)
     {
         for (int x = 0; x < GRID_SIZE; x++)
         {
-            if (x == player1X && y == player1Y)
-                std::cout << '1';
-            else if (x == player2X && y == player2Y)
-                std::cout << '2';
-            else
-                std::cout << grid[y][x];
+            std::cout << cellMarker(x, y);
         }
         std::cout << '\n';
     }
 }
 
-void Engine::printEndReason() const {
-    if(gameOver){
-        std::cout << endReason << '\n';
+template <typename Rules>
+void BasicEngine<Rules>::printEndReason() const {
+    if(game.isGameOver()){
+        std::cout << getEndReason() << '\n';
     }
     else{
         std::cout << "Game is still ongoing.\n";
     }
 }
 
-void Engine::logTurn(PlayerMove& player1Move, PlayerMove& player2Move)
+template <typename Rules>
+void BasicEngine<Rules>::logTurn(const std::array<PlayerMove, MAX_PLAYERS>& moves)
 {
     assert(getCurrentTurn() > 0);
     //Add grid if first move
     if(getCurrentTurn() == 1){
-        logs["grid"] = getGridString();
-    }
+        logs->writeGrid(getGridString(), game.getPlayerCount());
+    }
+
+    TurnRecord turn;
+    turn.turn = getCurrentTurn();
+    turn.players.resize(static_cast<std::size_t>(game.getPlayerCount()));
+
+    for(int i = 0; i < game.getPlayerCount(); i++){
+        const PlayerState& player = game.getPlayer(i);
+        PlayerRecord& record = turn.players[static_cast<std::size_t>(i)];
+        record.readError = outputReadErrors[i];
+        record.eliminated = player.lost;
+        record.move = moves[i];
+        record.x = player.x;
+        record.y = player.y;
+        record.hp = player.hp;
+        record.crystals = player.crystals;
+        record.attackCooldown = player.attackCooldown;
+        record.bombCooldown = player.bombCooldown;
+        record.responseTime = responseTimes[i];
+        record.cpuTime = cpuTimes[i];
+        record.writeSyscalls = writeSyscalls[i];
+    }
+
+    //Add the end reason and winner if the game is over
+    turn.gameOver = game.isGameOver();
+    if(turn.gameOver){
+        turn.winner = getWinner();
+        turn.endReason = getEndReason();
+    }
+
+    logs->writeTurn(turn);
+}
 
-    json turn;
+template <typename Rules>
+void BasicEngine<Rules>::writeLogs() {
+    logs->finish();
+}
 
-    //If error in the input format or while reading the input then set all moves to "ERROR"
-    if(player1OutputReadError){
-        turn["Player 1"] = {
-            {"MOVE", "ERROR"},
-            {"BOMB", "ERROR"},
-            {"ATTACK", "ERROR"}
-        };
-    }
-    else{
-        turn["Player 1"] = {
-            {"MOVE", player1Move.dir},
-            {"BOMB", std::make_pair(player1Move.bombX, player1Move.bombY)},
-            {"ATTACK", std::make_pair(player1Move.attackX, player1Move.attackY)}
-        };
-    }
-    if(player2OutputReadError){
-        turn["Player 2"] = {
-            {"MOVE", "ERROR"},
-            {"BOMB", "ERROR"},
-            {"ATTACK", "ERROR"}
-        };
-    }
-    else{
-        turn["Player 2"] = {
-            {"MOVE", player2Move.dir},
-            {"BOMB", std::make_pair(player2Move.bombX, player2Move.bombY)},
-            {"ATTACK", std::make_pair(player2Move.attackX, player2Move.attackY)}
-        };
-    }
-    //Add other details of the turn
-    turn["Player 1"]["Position"] = std::make_pair(player1X, player1Y);
-    turn["Player 2"]["Position"] = std::make_pair(player2X, player2Y);
-
-    turn["Player 1"]["HP"] = player1HP;
-    turn["Player 2"]["HP"] = player2HP;
-
-    turn["Player 1"]["Crystals"] = player1Crystals;
-    turn["Player 2"]["Crystals"] = player2Crystals;
-
-    turn["Player 1"]["Attack cooldown"] = player1AttackCooldown;
-    turn["Player 2"]["Attack cooldown"] = player2AttackCooldown;
-
-    turn["Player 1"]["Bomb cooldown"] = player1BombCooldown;
-    turn["Player 2"]["Bomb cooldown"] = player2BombCooldown;
-
-    //Check if game over to add the end reason and winner
-    if(gameOver){
-        turn["Game status"] = "Game Over";
-        turn["End reason"] = endReason;
-        if(player1Lost && player2Lost){
-            turn["Winner"] = "None (Tie)";
-        }
-        else if(player1Lost){
-            turn["Winner"] = "Player 2";
-        }
-        else{
-            turn["Winner"] = "Player 1";
+//Getter functions
+template <typename Rules>
+std::array<std::array<char, Rules::GRID_SIZE>, Rules::GRID_SIZE> BasicEngine<Rules>::getGrid() const requires (!Rules::SPARSE){
+    std::array<std::array<char, GRID_SIZE>, GRID_SIZE> grid;
+    for (int y = 0; y < GRID_SIZE; y++)
+    {
+        for (int x = 0; x < GRID_SIZE; x++)
+        {
+            grid[y][x] = game.getCell(x, y);
         }
     }
-    else{
-        turn["Game status"] = "Ongoing";
-    }
-    
-    logs["Turn " + std::to_string(getCurrentTurn())] = turn;
+    return grid;
 }
 
-void Engine::writeLogs() {
-    std::ofstream f(logsFilePath);
-    if (f.is_open()) {
-        f << logs.dump(4); //Pretty print with 4 spaces
-        f.close();
-    } else {
-        std::cerr << "Error opening logs file: " << logsFilePath << std::endl;
-    }
+template <typename Rules>
+const BasicGame<Rules>& BasicEngine<Rules>::getGame() const{
+    return game;
 }
 
-//Getter functions
-std::array<std::array<char, GRID_SIZE>, GRID_SIZE> Engine::getGrid() const{
-    return grid;
+template <typename Rules>
+int BasicEngine<Rules>::getTotalCrystals() const{
+    return game.getTotalCrystals();
 }
 
-int Engine::getTotalCrystals() const{
-    return totalCrystals;
+template <typename Rules>
+bool BasicEngine<Rules>::isGameOver() const{
+    return game.isGameOver();
 }
 
-bool Engine::isGameOver() const{
-    return gameOver;
+template <typename Rules>
+int BasicEngine<Rules>::getPlayerCount() const{
+    return game.getPlayerCount();
 }
 
-int Engine::getCurrentTurn() const{
-    return currentTurn;
+template <typename Rules>
+bool BasicEngine<Rules>::isEliminated(int player) const{
+    return game.getPlayer(player).lost;
 }
 
-int Engine::getAttackCooldown(int player) const{
-    if(player == 0){
-        return player1AttackCooldown;
-    }
-    else{
-        return player2AttackCooldown;
+template <typename Rules>
+bool BasicEngine<Rules>::usesBinaryProtocol(int player) const{
+    return protocols[player] == BINARY_PROTOCOL || protocols[player] == SHM_PROTOCOL;
+}
+
+template <typename Rules>
+bool BasicEngine<Rules>::usesSharedMemory(int player) const{
+    return protocols[player] == SHM_PROTOCOL;
+}
+
+template <typename Rules>
+void BasicEngine<Rules>::offerSharedMemory(int player){
+    sharedMemoryOffered[player] = true;
+}
+
+template <typename Rules>
+void BasicEngine<Rules>::usePlugin(int player){
+    plugins[player] = true;
+    protocols[player] = BINARY_PROTOCOL;
+}
+
+template <typename Rules>
+bool BasicEngine<Rules>::isMultiGame(int player) const{
+    return multiGame[player];
+}
+
+template <typename Rules>
+int BasicEngine<Rules>::getCurrentTurn() const{
+    return game.getCurrentTurn();
+}
+
+template <typename Rules>
+int BasicEngine<Rules>::getAttackCooldown(int player) const{
+    return game.getAttackCooldown(player);
+}
+
+template <typename Rules>
+int BasicEngine<Rules>::getBombCooldown(int player) const{
+    return game.getBombCooldown(player);
+}
+
+template <typename Rules>
+int BasicEngine<Rules>::getCrystals(int player) const{
+    return game.getCrystals(player);
+}
+
+template <typename Rules>
+std::string BasicEngine<Rules>::getLastMove(int player) const{
+    return std::string(directionName(game.getLastMove(player)));
+}
+
+template <typename Rules>
+int BasicEngine<Rules>::getWinner() const{
+    return game.getWinner();
+}
+
+template <typename Rules>
+std::string BasicEngine<Rules>::getEndReason() const{
+    return endReasonText(game.getEndReason(), game.getWinner(), Rules::MAX_TURNS);
+}
+
+template <typename Rules>
+int BasicEngine<Rules>::getEnemy(int player) const{
+    int enemy = -1, enemyDistance = 0;
+    for(int i = 0; i < game.getPlayerCount(); i++){
+        if(i == player || isEliminated(i)) continue;
+        int distance = std::abs(game.getX(i) - game.getX(player)) + std::abs(game.getY(i) - game.getY(player));
+        if(enemy == -1 || distance < enemyDistance){
+            enemy = i;
+            enemyDistance = distance;
+        }
     }
+    //Nobody else is left once the game is over
+    return enemy != -1 ? enemy : (player == 0 ? 1 : 0);
+}
+
+//Provides the appropriate game state string to be sent to `player`
+template <typename Rules>
+std::string BasicEngine<Rules>::getGameState(int player) const{
+    std::stringstream ss;
+    int enemy = getEnemy(player);
+
+    //Format: x y bombCooldown attackCooldown yourCrystals enemyCrystals yourHP enemyHP
+    ss << game.getX(player) << " " << game.getY(player) << " " << game.getBombCooldown(player) << " "
+    << game.getAttackCooldown(player) << " " << game.getCrystals(player) << " "
+    << game.getCrystals(enemy) << " " << game.getHP(player) << " " << game.getHP(enemy);
+    return ss.str();
 }
-int Engine::getBombCooldown(int player) const{
-    if(player == 0){
-        return player1BombCooldown;
+
+template <typename Rules>
+void BasicEngine<Rules>::appendObservation(std::string& out, int player, bool firstTurn) const{
+    if(!firstTurn && usesBinaryProtocol(player)){
+        appendFrame(out, player);
+        return;
+    }
+    if(firstTurn){
+        out += "GRID ";
+        out += std::to_string(GRID_SIZE);
+        out += '\n';
     }
     else{
-        return player2BombCooldown;
+        out += "MOVE ";
+        out += directionName(game.getLastMove(getEnemy(player)));
+        out += '\n';
+    }
+    out += getGameState(player);
+    out += '\n';
+    if constexpr (Rules::SPARSE)
+    {
+        if(firstTurn) appendSparseGrid(out);
+        else appendChanges(out);
+        return;
+    }
+    if(!firstTurn && protocols[player] == DELTA_PROTOCOL)
+    {
+        appendChanges(out);
+        return;
+    }
+    for(int y = 0; y < GRID_SIZE; y++)
+    {
+        for(int x = 0; x < GRID_SIZE; x++)
+        {
+            out += game.getCell(x, y);
+        }
+        out += '\n';
     }
 }
 
-int Engine::getCrystals(int player) const{
-    if(player == 0){
-        return player1Crystals;
-    }
-    else{
-        return player2Crystals;
+template <typename Rules>
+void BasicEngine<Rules>::appendChanges(std::string& out) const{
+    out += "CHANGES ";
+    out += std::to_string(changedCells.size());
+    out += '\n';
+    for(const auto& [x, y] : changedCells){
+        out += std::to_string(x);
+        out += ' ';
+        out += std::to_string(y);
+        out += ' ';
+        out += game.getCell(x, y);
+        out += '\n';
     }
 }
 
-std::string Engine::getLastMove(int player) const{
-    if(player == 0){
-        return player1LastMove;
+template <typename Rules>
+void BasicEngine<Rules>::appendFrame(std::string& out, int player) const{
+    std::size_t start = out.size();
+    appendInt32(out, 0); //Length, filled in at the end
+
+    int enemy = getEnemy(player);
+    appendInt32(out, static_cast<int>(game.getLastMove(enemy)));
+    for(int value : {game.getX(player), game.getY(player), game.getBombCooldown(player),
+                     game.getAttackCooldown(player), game.getCrystals(player), game.getCrystals(enemy),
+                     game.getHP(player), game.getHP(enemy)}){
+        appendInt32(out, value);
     }
-    else{
-        return player2LastMove;
+    appendInt32(out, static_cast<int>(changedCells.size()));
+    for(const auto& [x, y] : changedCells){
+        appendInt32(out, x);
+        appendInt32(out, y);
+        appendInt32(out, game.getCell(x, y));
     }
-}
 
-//Provides the appropriate game state string to be sent to `player`
-std::string Engine::getGameState(int player) const{
-    std::stringstream ss;
+    std::int32_t length = static_cast<std::int32_t>(out.size() - start - sizeof(length));
+    std::memcpy(out.data() + start, &length, sizeof(length));
+}
 
-    //Format: x y bombCooldown attackCooldown yourCrystals enemyCrystals yourHP enemyHP
-    if(player == 0){
-        ss << player1X << " " << player1Y << " " << player1BombCooldown << " "
-        << player1AttackCooldown << " " << player1Crystals << " " 
-        << player2Crystals << " " << player1HP << " " << player2HP;
+template <typename Rules>
+void BasicEngine<Rules>::getPluginObservation(int player, bool firstTurn, BotObservation& observation,
+                                              std::string& grid, std::vector<std::int32_t>& changes) const{
+    int enemy = getEnemy(player);
+    observation.gridSize = GRID_SIZE;
+    observation.enemyMove = firstTurn ? 0 : static_cast<std::int32_t>(game.getLastMove(enemy));
+    observation.x = game.getX(player);
+    observation.y = game.getY(player);
+    observation.bombCooldown = game.getBombCooldown(player);
+    observation.attackCooldown = game.getAttackCooldown(player);
+    observation.crystals = game.getCrystals(player);
+    observation.enemyCrystals = game.getCrystals(enemy);
+    observation.hp = game.getHP(player);
+    observation.enemyHP = game.getHP(enemy);
+
+    observation.grid = nullptr;
+    observation.changeCount = 0;
+    observation.changes = nullptr;
+    if(firstTurn){
+        grid.resize(static_cast<std::size_t>(GRID_SIZE) * GRID_SIZE);
+        for(int y = 0; y < GRID_SIZE; y++){
+            for(int x = 0; x < GRID_SIZE; x++){
+                grid[static_cast<std::size_t>(y) * GRID_SIZE + static_cast<std::size_t>(x)] = game.getCell(x, y);
+            }
+        }
+        observation.grid = grid.data();
+        return;
     }
-    else{
-        ss << player2X << " " << player2Y << " " << player2BombCooldown << " "
-        << player2AttackCooldown << " " << player2Crystals << " "
-        << player1Crystals << " " << player2HP << " " << player1HP;
+    changes.clear();
+    for(const auto& [x, y] : changedCells){
+        changes.insert(changes.end(), {x, y, game.getCell(x, y)});
     }
-    return ss.str();
-}
\ No newline at end of file
+    observation.changeCount = static_cast<std::int32_t>(changedCells.size());
+    observation.changes = changes.data();
+}
+
+template <typename Rules>
+void BasicEngine<Rules>::appendSparseGrid(std::string& out) const requires (Rules::SPARSE){
+    auto appendCell = [&out](int x, int y){
+        out += std::to_string(x);
+        out += ' ';
+        out += std::to_string(y);
+        out += '\n';
+    };
+    out += "OBSTACLES " + std::to_string(game.getObstacleCells().count()) + '\n';
+    game.getObstacleCells().forEach(appendCell);
+    out += "CRYSTALS " + std::to_string(game.getCrystalCells().count()) + '\n';
+    game.getCrystalCells().forEach(appendCell);
+}
+
+template class BasicEngine<StandardRules>;
+template class BasicEngine<Rules32>;
+template class BasicEngine<Rules64>;
+template class BasicEngine<RulesLarge>;
@@ -0,0 +1,935 @@
+#include "../include/game.h"
+#include "../include/bitboard.h"
+#include "../include/move.h"
+#include <random>
+#include <string>
+#include <array>
+#include <cstdlib>
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <utility>
+
+namespace {
+
+//Next number of the splitmix64 generator, which starts at `seed`
+constexpr std::uint64_t splitmix64(std::uint64_t& seed){
+    std::uint64_t z = (seed += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+//Random keys of the Zobrist hash, one for each value of each part of the state.
+//The hash of a state is the XOR of the keys of its values.
+template <typename Rules>
+struct ZobristKeys{
+    static constexpr int CELLS = Rules::GRID_SIZE * Rules::GRID_SIZE;
+    static constexpr int MAX_CRYSTALS = Rules::MIN_CRYSTALS + 10; //Most crystals a map can have
+
+
+    std::array<std::uint64_t, CELLS> crystal;
+    std::array<std::array<std::uint64_t, CELLS>, MAX_PLAYERS> position;
+    std::array<std::array<std::uint64_t, Rules::INITIAL_HP + 1>, MAX_PLAYERS> hp;
+    std::array<std::array<std::uint64_t, MAX_CRYSTALS + 1>, MAX_PLAYERS> crystals;
+    std::array<std::array<std::uint64_t, Rules::BOMB_COOLDOWN + 1>, MAX_PLAYERS> bombCooldown;
+    std::array<std::array<std::uint64_t, Rules::ATTACK_COOLDOWN + 1>, MAX_PLAYERS> attackCooldown;
+    std::array<std::uint64_t, MAX_PLAYERS> lost; //XORed in while the player has lost
+    std::array<std::uint64_t, MAX_CRYSTALS + 1> totalCrystals;
+    std::array<std::uint64_t, Rules::MAX_TURNS + 1> turn;
+};
+
+//Generated at compile time (with splitmix64) so hashes are the same in every run
+template <typename Rules>
+constexpr ZobristKeys<Rules> makeZobristKeys(){
+    ZobristKeys<Rules> keys {};
+    std::uint64_t seed = 0x9E3779B97F4A7C15;
+    auto next = [&seed]{
+        return splitmix64(seed);
+    };
+    auto fill = [&next](auto& table){
+        for(std::uint64_t& key : table) key = next();
+    };
+
+    fill(keys.crystal);
+    for(int player = 0; player < MAX_PLAYERS; player++){
+        fill(keys.position[player]);
+        fill(keys.hp[player]);
+        fill(keys.crystals[player]);
+        fill(keys.bombCooldown[player]);
+        fill(keys.attackCooldown[player]);
+    }
+    fill(keys.lost);
+    fill(keys.totalCrystals);
+    fill(keys.turn);
+    return keys;
+}
+
+//Keys of one part of the state computed from the value when they are used, for the sparse maps:
+//their tables would take hundreds of MB (a position key for each cell and each player)
+struct ComputedKeys{
+    std::uint64_t salt {};
+
+    constexpr std::uint64_t operator[](int value) const{
+        std::uint64_t seed = salt ^ (static_cast<std::uint64_t>(value) * 0xD1B54A32D192ED03);
+        return splitmix64(seed);
+    }
+};
+
+//The same parts as ZobristKeys
+struct ComputedZobristKeys{
+    ComputedKeys crystal;
+    std::array<ComputedKeys, MAX_PLAYERS> position;
+    std::array<ComputedKeys, MAX_PLAYERS> hp;
+    std::array<ComputedKeys, MAX_PLAYERS> crystals;
+    std::array<ComputedKeys, MAX_PLAYERS> bombCooldown;
+    std::array<ComputedKeys, MAX_PLAYERS> attackCooldown;
+    ComputedKeys lost;
+    ComputedKeys totalCrystals;
+    ComputedKeys turn;
+};
+
+constexpr ComputedZobristKeys makeComputedZobristKeys(){
+    ComputedZobristKeys keys {};
+    std::uint64_t seed = 0x9E3779B97F4A7C15;
+    auto salt = [&seed](ComputedKeys& part){
+        part.salt = splitmix64(seed);
+    };
+
+    salt(keys.crystal);
+    for(int player = 0; player < MAX_PLAYERS; player++){
+        salt(keys.position[player]);
+        salt(keys.hp[player]);
+        salt(keys.crystals[player]);
+        salt(keys.bombCooldown[player]);
+        salt(keys.attackCooldown[player]);
+    }
+    salt(keys.lost);
+    salt(keys.totalCrystals);
+    salt(keys.turn);
+    return keys;
+}
+
+template <typename Rules>
+constexpr auto zobrist = []{
+    if constexpr (Rules::SPARSE) return makeComputedZobristKeys();
+    else return makeZobristKeys<Rules>();
+}();
+
+template <typename Rules>
+constexpr int cellIndex(int x, int y){
+    return y * Rules::GRID_SIZE + x;
+}
+
+//Sets `field` to `value`, swapping the key of its old value for the new one in `hash`
+template <typename Keys>
+void setHashed(std::uint64_t& hash, const Keys& keys, int& field, int value){
+    hash ^= keys[field] ^ keys[value];
+    field = value;
+}
+
+} // namespace
+
+EndReason faultReason(const std::array<PlayerState, MAX_PLAYERS>& players,
+                      EndReason all, EndReason player1, EndReason player2){
+    if(players[0].lost && players[1].lost) return all;
+    return players[0].lost ? player1 : player2;
+}
+
+std::string endReasonText(EndReason reason, int winner, int maxTurns){
+    std::string player = "Player " + std::to_string(winner + 1);
+    switch(reason){
+        case EndReason::BOTH_INVALID_MOVE:
+            return "Tie: Both players sent an invalid move";
+        case EndReason::PLAYER1_INVALID_MOVE:
+            return "Player 2 wins as Player 1 sent an invalid move";
+        case EndReason::PLAYER2_INVALID_MOVE:
+            return "Player 1 wins as Player 2 sent an invalid move";
+        case EndReason::BOTH_DIED_PLAYER1_MORE_CRYSTALS:
+            return "Player 1 wins as both players have died and Player 1 has more crystals";
+        case EndReason::BOTH_DIED_PLAYER2_MORE_CRYSTALS:
+            return "Player 2 wins as both players have died and Player 2 has more crystals";
+        case EndReason::BOTH_DIED_SAME_CRYSTALS:
+            return "Tie: Both players lost all HP and have the same number of crystals";
+        case EndReason::PLAYER1_NO_HP:
+            return "Player 2 wins as Player 1 lost all HP";
+        case EndReason::PLAYER2_NO_HP:
+            return "Player 1 wins as Player 2 lost all HP";
+        case EndReason::CRYSTALS_GONE_PLAYER1_MORE_CRYSTALS:
+            return "Player 1 wins as all crystals have been collected and Player 1 has more crystals";
+        case EndReason::CRYSTALS_GONE_PLAYER2_MORE_CRYSTALS:
+            return "Player 2 wins as all crystals have been collected and Player 2 has more crystals";
+        case EndReason::CRYSTALS_GONE_PLAYER1_MORE_HP:
+            return "Player 1 wins as all crystals have been collected and Player 1 has more HP";
+        case EndReason::CRYSTALS_GONE_PLAYER2_MORE_HP:
+            return "Player 2 wins as all crystals have been collected and Player 2 has more HP";
+        case EndReason::CRYSTALS_GONE_SAME_HP:
+            return "Tie: All crystals have been collected and both players have the same HP";
+        case EndReason::MAX_TURNS_PLAYER1_MORE_CRYSTALS:
+            return std::string("Player 1 wins as ") +
+                        std::to_string(maxTurns) +
+                        std::string(" moves have been played and Player 1 has more crystals");
+        case EndReason::MAX_TURNS_PLAYER2_MORE_CRYSTALS:
+            return std::string("Player 1 wins as ") +
+                        std::to_string(maxTurns) +
+                        std::string(" moves have been played and Player 2 has more crystals");
+        case EndReason::MAX_TURNS_PLAYER1_MORE_HP:
+            return std::string("Player 1 wins as ") +
+                            std::to_string(maxTurns) +
+                            std::string(" moves have been played, both players have the same crystals and Player 1 has more HP");
+        case EndReason::MAX_TURNS_PLAYER2_MORE_HP:
+            return std::string("Player 1 wins as ") +
+                            std::to_string(maxTurns) +
+                            std::string(" moves have been played, both players have the same crystals and Player 2 has more HP");
+        case EndReason::MAX_TURNS_SAME_HP:
+            return std::string("Tie: ") +
+                            std::to_string(maxTurns) +
+                            std::string(" moves have been played and both players have the same crystals and HP");
+        case EndReason::BOTH_READ_ERROR:
+            return "Tie: Error encountered while reading input from both players";
+        case EndReason::PLAYER1_READ_ERROR:
+            return "Player 2 wins as error encountered while reading input from Player 1";
+        case EndReason::PLAYER2_READ_ERROR:
+            return "Player 1 wins as error encountered while reading input from Player 2";
+        case EndReason::LAST_PLAYER_STANDING:
+            return player + " wins as all other players have been eliminated";
+        case EndReason::ALL_ELIMINATED:
+            return "Tie: All players left were eliminated in the same turn";
+        case EndReason::CRYSTALS_GONE_MOST_CRYSTALS:
+            return player + " wins as all crystals have been collected and " + player + " has the most crystals";
+        case EndReason::CRYSTALS_GONE_MOST_HP:
+            return player + " wins as all crystals have been collected, several players have the most crystals and " +
+                   player + " has the most HP";
+        case EndReason::CRYSTALS_GONE_TIE:
+            return "Tie: All crystals have been collected and several players have the most crystals and HP";
+        case EndReason::MAX_TURNS_MOST_CRYSTALS:
+            return player + " wins as " + std::to_string(maxTurns) +
+                   " moves have been played and " + player + " has the most crystals";
+        case EndReason::MAX_TURNS_MOST_HP:
+            return player + " wins as " + std::to_string(maxTurns) +
+                   " moves have been played, several players have the most crystals and " + player + " has the most HP";
+        case EndReason::MAX_TURNS_TIE:
+            return std::string("Tie: ") + std::to_string(maxTurns) +
+                   " moves have been played and several players have the most crystals and HP";
+        default:
+            return "";
+    }
+}
+
+EndReason turnEndReason(const std::array<int, 2>& hp, const std::array<int, 2>& crystals,
+                        int totalCrystals, int currentTurn, int maxTurns){
+    int player1HP = hp[0], player2HP = hp[1];
+    int player1Crystals = crystals[0], player2Crystals = crystals[1];
+
+    //Check if any player has lost all HP
+    //(Player 1 is checked first, so if both lose their last HP in the same turn Player 2 wins)
+    if(player1HP <= 0){
+        assert(player1HP == 0);
+        return EndReason::PLAYER1_NO_HP;
+    }
+    if(player2HP <= 0){
+        assert(player2HP == 0);
+        return EndReason::PLAYER2_NO_HP;
+    }
+
+    //Check if no crystals are left
+    if(totalCrystals <= 0){
+        assert(totalCrystals == 0);
+        if(player1Crystals > player2Crystals){
+            return EndReason::CRYSTALS_GONE_PLAYER1_MORE_CRYSTALS;
+        }
+        else if(player2Crystals > player1Crystals){
+            return EndReason::CRYSTALS_GONE_PLAYER2_MORE_CRYSTALS;
+        }
+        //Crystals are equal so check HP
+        if(player1HP > player2HP){
+            return EndReason::CRYSTALS_GONE_PLAYER1_MORE_HP;
+        }
+        else if(player2HP > player1HP){
+            return EndReason::CRYSTALS_GONE_PLAYER2_MORE_HP;
+        }
+        return EndReason::CRYSTALS_GONE_SAME_HP;
+    }
+
+    //Check if max moves have been played
+    if(currentTurn >= maxTurns){
+        if(player1Crystals > player2Crystals){
+            return EndReason::MAX_TURNS_PLAYER1_MORE_CRYSTALS;
+        }
+        else if(player2Crystals > player1Crystals){
+            return EndReason::MAX_TURNS_PLAYER2_MORE_CRYSTALS;
+        }
+        //Crystals are equal so check HP
+        if(player1HP > player2HP){
+            return EndReason::MAX_TURNS_PLAYER1_MORE_HP;
+        }
+        else if(player2HP > player1HP){
+            return EndReason::MAX_TURNS_PLAYER2_MORE_HP;
+        }
+        return EndReason::MAX_TURNS_SAME_HP;
+    }
+
+    return EndReason::NONE;
+}
+
+int endReasonWinner(EndReason reason){
+    switch(reason){
+        case EndReason::PLAYER2_INVALID_MOVE:
+        case EndReason::PLAYER2_NO_HP:
+        case EndReason::CRYSTALS_GONE_PLAYER1_MORE_CRYSTALS:
+        case EndReason::CRYSTALS_GONE_PLAYER1_MORE_HP:
+        case EndReason::MAX_TURNS_PLAYER1_MORE_CRYSTALS:
+        case EndReason::MAX_TURNS_PLAYER1_MORE_HP:
+        case EndReason::PLAYER2_READ_ERROR:
+            return 0;
+        case EndReason::PLAYER1_INVALID_MOVE:
+        case EndReason::PLAYER1_NO_HP:
+        case EndReason::CRYSTALS_GONE_PLAYER2_MORE_CRYSTALS:
+        case EndReason::CRYSTALS_GONE_PLAYER2_MORE_HP:
+        case EndReason::MAX_TURNS_PLAYER2_MORE_CRYSTALS:
+        case EndReason::MAX_TURNS_PLAYER2_MORE_HP:
+        case EndReason::PLAYER1_READ_ERROR:
+            return 1;
+        default:
+            //Ties, and both players dying counts as a tie whatever the crystals.
+            //Free-for-all reasons do not say who won.
+            return -1;
+    }
+}
+
+EndReason freeForAllEndReason(const std::array<PlayerState, MAX_PLAYERS>& players, int playerCount,
+                              int totalCrystals, int currentTurn, int maxTurns, int& winner){
+    winner = -1;
+    int left = 0;
+    for(int i = 0; i < playerCount; i++){
+        if(players[i].lost) continue;
+        left++;
+        winner = i;
+    }
+    if(left <= 1){
+        return winner != -1 ? EndReason::LAST_PLAYER_STANDING : EndReason::ALL_ELIMINATED;
+    }
+    winner = -1;
+    if(totalCrystals > 0 && currentTurn < maxTurns){
+        return EndReason::NONE;
+    }
+
+    //The best player left by crystals then HP, and whether another one is as good
+    bool tie = false, sameCrystals = false;
+    for(int i = 0; i < playerCount; i++){
+        const PlayerState& player = players[i];
+        if(player.lost) continue;
+        if(winner == -1){
+            winner = i;
+            continue;
+        }
+        const PlayerState& best = players[winner];
+        if(player.crystals != best.crystals){
+            if(player.crystals > best.crystals){
+                winner = i;
+                tie = sameCrystals = false;
+            }
+            continue;
+        }
+        sameCrystals = true;
+        if(player.hp > best.hp){
+            winner = i;
+            tie = false;
+        }
+        else if(player.hp == best.hp){
+            tie = true;
+        }
+    }
+
+    bool crystalsGone = totalCrystals <= 0;
+    if(tie){
+        winner = -1;
+        return crystalsGone ? EndReason::CRYSTALS_GONE_TIE : EndReason::MAX_TURNS_TIE;
+    }
+    if(sameCrystals){
+        return crystalsGone ? EndReason::CRYSTALS_GONE_MOST_HP : EndReason::MAX_TURNS_MOST_HP;
+    }
+    return crystalsGone ? EndReason::CRYSTALS_GONE_MOST_CRYSTALS : EndReason::MAX_TURNS_MOST_CRYSTALS;
+}
+
+template <typename Rules>
+BasicGame<Rules>::BasicGame(unsigned seed, int players)
+{
+    assert(players >= 2 && players <= MAX_PLAYERS);
+    state.playerCount = players;
+    for (PlayerState& player : state.players)
+    {
+        player.hp = INITIAL_HP;
+    }
+    std::mt19937 rng(seed);
+    initialiseGrid(rng);
+}
+
+template <typename Rules>
+bool BasicGame<Rules>::isValidPosition(int x, int y) {
+    return x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_SIZE;
+}
+
+template <typename Rules>
+bool BasicGame<Rules>::isEmptyCell(int x, int y) const {
+    return isValidPosition(x, y) && !state.crystals.test(x, y) && !cells.obstacles.test(x, y);
+}
+
+template <typename Rules>
+bool BasicGame<Rules>::isCrystalCell(int x, int y) const {
+    return isValidPosition(x, y) && state.crystals.test(x, y);
+}
+
+template <typename Rules>
+bool BasicGame<Rules>::isObstacleCell(int x, int y) const {
+    return isValidPosition(x, y) && cells.obstacles.test(x, y);
+}
+
+template <typename Rules>
+char BasicGame<Rules>::cellChar(int x, int y) const {
+    if(cells.obstacles.test(x, y)) return '#';
+    if(state.crystals.test(x, y)) return 'C';
+    return '.';
+}
+
+template <typename Rules>
+int BasicGame<Rules>::manhattanDistance(int x1, int y1, int x2, int y2) const {
+    return std::abs(x1 - x2) + std::abs(y1 - y2);
+}
+
+template <typename Rules>
+void BasicGame<Rules>::initialiseGrid(std::mt19937& rng){
+    state.crystals = {};
+    cells.obstacles = {};
+
+    std::uniform_real_distribution<float> disMult(0, 0.1f);
+    float obstacleMultiplier = disMult(rng);
+
+    //Randomly place obstacles in 0% - 10% of the grid
+    int obstacleCount = static_cast<int>(GRID_SIZE * GRID_SIZE * obstacleMultiplier);
+
+    if constexpr (Rules::SPARSE)
+    {
+        placeCellsDistinct(rng, obstacleCount);
+    }
+    else
+    {
+        placeCellsRejecting(rng, obstacleCount);
+    }
+    cells.prepare();
+
+    placePlayers(rng);
+
+    state.hash = computeHash();
+}
+
+template <typename Rules>
+void BasicGame<Rules>::drawTotalCrystals(std::mt19937& rng){
+    std::uniform_int_distribution<int> disCrystal(0, 9);
+    state.totalCrystals = MIN_CRYSTALS  + disCrystal(rng);
+    if(state.totalCrystals % 2 == 0){
+        state.totalCrystals++; //Ensure odd number of crystals
+    }
+}
+
+//Draws random cells until an empty one is found for each obstacle then each crystal
+template <typename Rules>
+void BasicGame<Rules>::placeCellsRejecting(std::mt19937& rng, int obstacleCount){
+    std::uniform_int_distribution<int> disGrid(0, GRID_SIZE - 1);
+    int x, y;
+
+    for (int i = 0; i < obstacleCount; i++)
+    {
+        do{
+            x = disGrid(rng);
+            y = disGrid(rng);
+        } while (!isEmptyCell(x, y));
+
+        cells.obstacles.set(x, y);
+    }
+
+    drawTotalCrystals(rng);
+
+    //Randomly place crystals in the grid
+    for (int i = 0; i < state.totalCrystals; i++)
+    {
+        do{
+            x = disGrid(rng);
+            y = disGrid(rng);
+        } while (!isEmptyCell(x, y));
+
+        state.crystals.set(x, y);
+    }
+}
+
+//Same densities as placeCellsRejecting(), but the cells are drawn without rejection so generating
+//a sparse map costs the number of obstacles and crystals, not retries that grow with the grid
+template <typename Rules>
+void BasicGame<Rules>::placeCellsDistinct(std::mt19937& rng, int obstacleCount){
+    constexpr int CELLS = GRID_SIZE * GRID_SIZE;
+
+    drawTotalCrystals(rng);
+
+    //Distinct cells for the obstacles and crystals (Floyd's algorithm): for each j from
+    //CELLS - count to CELLS - 1, take a random cell up to j, or j itself if that one is already taken
+    int count = obstacleCount + state.totalCrystals;
+    std::vector<int> drawn;
+    drawn.reserve(static_cast<std::size_t>(count));
+    typename Cells::Grid taken;
+    for (int j = CELLS - count; j < CELLS; j++)
+    {
+        int cell = std::uniform_int_distribution<int>(0, j)(rng);
+        if (taken.test(cell % GRID_SIZE, cell / GRID_SIZE)) cell = j;
+        taken.set(cell % GRID_SIZE, cell / GRID_SIZE);
+        drawn.push_back(cell);
+    }
+
+    //A random subset of them are the crystals (partial shuffle), the rest are obstacles
+    for (int i = 0; i < count; i++)
+    {
+        std::size_t index = static_cast<std::size_t>(i);
+        if (i < state.totalCrystals)
+        {
+            std::swap(drawn[index], drawn[static_cast<std::size_t>(std::uniform_int_distribution<int>(i, count - 1)(rng))]);
+            state.crystals.set(drawn[index] % GRID_SIZE, drawn[index] / GRID_SIZE);
+        }
+        else
+        {
+            cells.obstacles.set(drawn[index] % GRID_SIZE, drawn[index] / GRID_SIZE);
+        }
+    }
+}
+
+template <typename Rules>
+void BasicGame<Rules>::placePlayers(std::mt19937& rng){
+    if (state.playerCount == 2)
+    {
+        //Place players in opposite halves (left/right) of the grid
+        std::uniform_int_distribution<int> disGridHalf(0, GRID_SIZE / 2 - 1);
+        do {
+            state.players[0].x = disGridHalf(rng);
+            state.players[0].y = disGridHalf(rng);
+        } while (!isEmptyCell(state.players[0].x, state.players[0].y));
+
+        do {
+            state.players[1].x = (GRID_SIZE / 2) + disGridHalf(rng);
+            state.players[1].y = (GRID_SIZE / 2) + disGridHalf(rng);
+        } while (!isEmptyCell(state.players[1].x, state.players[1].y));
+        return;
+    }
+
+    //More players are spread over a grid of columns x rows regions, one player per region
+    //filled row by row, so nobody starts next to another player
+    int columns = 1;
+    while (columns * columns < state.playerCount) columns++;
+    int rows = (state.playerCount + columns - 1) / columns;
+
+    std::uniform_int_distribution<int> disRegionX(0, GRID_SIZE / columns - 1);
+    std::uniform_int_distribution<int> disRegionY(0, GRID_SIZE / rows - 1);
+    for (int i = 0; i < state.playerCount; i++)
+    {
+        PlayerState& player = state.players[i];
+        int left = (i % columns) * (GRID_SIZE / columns);
+        int top = (i / columns) * (GRID_SIZE / rows);
+        do {
+            player.x = left + disRegionX(rng);
+            player.y = top + disRegionY(rng);
+        } while (!isEmptyCell(player.x, player.y));
+    }
+}
+
+template <typename Rules>
+void BasicGame<Rules>::setLost(int player, bool lost){
+    if (state.players[player].lost != lost)
+    {
+        state.hash ^= zobrist<Rules>.lost[player];
+    }
+    state.players[player].lost = lost;
+}
+
+//Move the player in the specified direction
+//Returns true if the move is valid, false otherwise.
+template <typename Rules>
+bool BasicGame<Rules>::movePlayer(int player, Direction move) {
+    int& playerX = state.players[player].x;
+    int& playerY = state.players[player].y;
+
+    int newX = playerX, newY = playerY;
+
+    if (move == Direction::UP) newY--;
+    else if (move == Direction::DOWN) newY++;
+    else if (move == Direction::LEFT) newX--;
+    else if (move == Direction::RIGHT) newX++;
+
+    if (!isValidPosition(newX, newY) || !isEmptyCell(newX, newY)) {
+        return false; // Invalid move
+    }
+    state.hash ^= zobrist<Rules>.position[player][cellIndex<Rules>(playerX, playerY)] ^
+                  zobrist<Rules>.position[player][cellIndex<Rules>(newX, newY)];
+    playerX = newX;
+    playerY = newY;
+    return true;
+}
+
+template <typename Rules>
+Bitboard<Rules::GRID_SIZE> computeExplosionArea(const Bitboard<Rules::GRID_SIZE>& obstacles, int x, int y){
+    return Rules::Cells::computeArea(obstacles, x, y);
+}
+
+template <typename Rules>
+bool BasicGame<Rules>::isValidMove(const PlayerState& player, const PlayerMove& move) const
+{
+    // A move that could not be parsed has no direction
+    if (move.dir == Direction::NONE)
+    {
+        return false;
+    }
+
+    if (move.placesBomb())
+    {
+        // Check if BOMB is placed on an empty cell, within range and after the cooldown is over
+        if (!isEmptyCell(move.bombX, move.bombY) || player.bombCooldown > 0 ||
+            manhattanDistance(player.x, player.y, move.bombX, move.bombY) > BOMB_RANGE)
+        {
+            return false;
+        }
+    }
+
+    // Check if ATTACK is placed within range
+    if (move.attacks() &&
+        manhattanDistance(player.x, player.y, move.attackX, move.attackY) > ATTACK_RANGE)
+    {
+        return false;
+    }
+    return true;
+}
+
+template <typename Rules>
+void BasicGame<Rules>::playTurn(const std::array<PlayerMove, MAX_PLAYERS>& moves)
+{
+    const int players = state.playerCount;
+    if constexpr (Rules::SPARSE) changedCells.clear();
+
+    // Every valid move is made, even if another player's move is not valid
+    bool anyLost = false;
+    for (int i = 0; i < players; i++)
+    {
+        PlayerState& player = state.players[i];
+        if (player.lost) continue; // Eliminated earlier in a free-for-all
+        setLost(i, !isValidMove(player, moves[i]) || !movePlayer(i, moves[i].dir));
+        anyLost = anyLost || player.lost;
+    }
+
+    // All moves have been verified for validity.
+    // In a free-for-all the players who sent an invalid move are out and the others play on.
+    if (anyLost && players == 2)
+    {
+        state.gameOver = true;
+        state.endReason = faultReason(state.players, EndReason::BOTH_INVALID_MOVE,
+                                      EndReason::PLAYER1_INVALID_MOVE, EndReason::PLAYER2_INVALID_MOVE);
+        setHashed(state.hash, zobrist<Rules>.turn, state.currentTurn, state.currentTurn + 1);
+        return;
+    }
+
+    // All players left have made valid moves and moved successfully
+    std::array<typename Cells::AreaRef, MAX_PLAYERS> explosionAreas;
+
+    for (int i = 0; i < players; i++)
+    {
+        PlayerState& player = state.players[i];
+        const PlayerMove& move = moves[i];
+        if (player.lost)
+        {
+            explosionAreas[i] = Cells::noArea();
+            continue;
+        }
+
+        // Store the last moves so it can be sent in the next turn
+        player.lastMove = move.dir;
+
+        // Update cooldowns
+        setHashed(state.hash, zobrist<Rules>.attackCooldown[i], player.attackCooldown,
+                  move.attacks() ? ATTACK_COOLDOWN : std::max(0, player.attackCooldown - 1));
+        setHashed(state.hash, zobrist<Rules>.bombCooldown[i], player.bombCooldown,
+                  move.placesBomb() ? BOMB_COOLDOWN : std::max(0, player.bombCooldown - 1));
+
+        // Cells affected by the bomb (nothing is allocated)
+        explosionAreas[i] = move.placesBomb() ? cells.bombArea(move.bombX, move.bombY) : Cells::noArea();
+    }
+
+    // A crystal bombed by several players is destroyed, whichever players they are
+    for (int i = 0; i < players; i++)
+    {
+        if (state.players[i].lost) continue;
+        collectCrystals(i, std::span(explosionAreas).first(static_cast<std::size_t>(players)));
+    }
+
+    // Attack area is the same as explosion area
+    for (int i = 0; i < players; i++)
+    {
+        const PlayerMove& move = moves[i];
+        if (state.players[i].lost || !move.attacks()) continue;
+
+        for (int j = 0; j < players; j++)
+        {
+            PlayerState& target = state.players[j];
+            if (j != i && !target.lost && cells.attackHits(move.attackX, move.attackY, target.x, target.y))
+            {
+                // Several players can hit the same one, HP stops at 0
+                setHashed(state.hash, zobrist<Rules>.hp[j], target.hp, std::max(0, target.hp - 1));
+            }
+        }
+    }
+
+    // Crystals have been collected and players have attacked
+    // Now we need to check if game is over
+    setHashed(state.hash, zobrist<Rules>.turn, state.currentTurn, state.currentTurn + 1);
+    checkGameOver();
+}
+
+//To be used when both players have provided correct input and already moved
+//gameOver must not be set to true before checking this
+template <typename Rules>
+bool BasicGame<Rules>::checkGameOver(){
+    if(state.gameOver) return true;
+    if(state.playerCount > 2) return checkFreeForAllOver();
+
+    std::array<int, 2> hp, crystals;
+    for(int i = 0; i < 2; i++){
+        hp[i] = state.players[i].hp;
+        crystals[i] = state.players[i].crystals;
+    }
+    EndReason reason = turnEndReason(hp, crystals, state.totalCrystals, state.currentTurn, MAX_TURNS);
+    if(reason == EndReason::NONE) return false; //Game is still ongoing
+
+    int winner = endReasonWinner(reason);
+    state.gameOver = true;
+    for(int i = 0; i < 2; i++){
+        setLost(i, winner != i);
+    }
+    state.endReason = reason;
+    return true;
+}
+
+//Players with no HP left are eliminated, then the game ends as freeForAllEndReason() says
+template <typename Rules>
+bool BasicGame<Rules>::checkFreeForAllOver(){
+    for(int i = 0; i < state.playerCount; i++){
+        if(!state.players[i].lost && state.players[i].hp <= 0){
+            setLost(i, true);
+        }
+    }
+
+    int winner = -1;
+    EndReason reason = freeForAllEndReason(state.players, state.playerCount, state.totalCrystals,
+                                           state.currentTurn, MAX_TURNS, winner);
+    if(reason == EndReason::NONE) return false; //Game is still ongoing
+
+    state.gameOver = true;
+    for(int i = 0; i < state.playerCount; i++){
+        if(i != winner) setLost(i, true);
+    }
+    state.endReason = reason;
+    return true;
+}
+
+//Used if there is an error while reading input from the players
+//This is not for invalid input but rather errors in the input reading process itself
+template <typename Rules>
+void BasicGame<Rules>::forfeit(const std::array<bool, MAX_PLAYERS>& readError){
+    if constexpr (Rules::SPARSE) changedCells.clear();
+    if(state.playerCount > 2){
+        //Only the players at fault are out, the others play the turn with playTurn() if enough are left
+        int left = 0;
+        for(int i = 0; i < state.playerCount; i++){
+            if(readError[i]) setLost(i, true);
+            if(!state.players[i].lost) left++;
+        }
+        if(left <= 1){
+            setHashed(state.hash, zobrist<Rules>.turn, state.currentTurn, state.currentTurn + 1);
+            checkFreeForAllOver();
+        }
+        return;
+    }
+
+    bool anyError = false;
+    for(int i = 0; i < 2; i++){
+        setLost(i, readError[i]);
+        anyError = anyError || readError[i];
+    }
+    assert(anyError);
+
+    state.gameOver = true;
+    state.endReason = faultReason(state.players, EndReason::BOTH_READ_ERROR,
+                                  EndReason::PLAYER1_READ_ERROR, EndReason::PLAYER2_READ_ERROR);
+
+    setHashed(state.hash, zobrist<Rules>.turn, state.currentTurn, state.currentTurn + 1);
+}
+
+template <typename Rules>
+void BasicGame<Rules>::collectCrystals(int player, std::span<const typename Cells::AreaRef> explosionAreas){
+    int& playerCrystals = state.players[player].crystals;
+
+    //Crystals bombed by several players are destroyed, the rest are collected by the player
+    int collected, destroyed;
+    Cells::collect(state.crystals, explosionAreas, player, collected, destroyed, [this](int x, int y){
+        state.hash ^= zobrist<Rules>.crystal[cellIndex<Rules>(x, y)];
+        if constexpr (Rules::SPARSE) changedCells.emplace_back(x, y);
+    });
+    setHashed(state.hash, zobrist<Rules>.totalCrystals, state.totalCrystals, state.totalCrystals - destroyed);
+    setHashed(state.hash, zobrist<Rules>.crystals[player], playerCrystals, playerCrystals + collected);
+}
+
+template <typename Rules>
+const BasicGameState<Rules>& BasicGame<Rules>::snapshot() const{
+    return state;
+}
+
+template <typename Rules>
+void BasicGame<Rules>::restore(const BasicGameState<Rules>& saved){
+    state = saved;
+}
+
+template <typename Rules>
+BasicGameState<Rules> BasicGame<Rules>::makeTurn(const std::array<PlayerMove, MAX_PLAYERS>& moves){
+    BasicGameState<Rules> undo = state;
+    playTurn(moves);
+    return undo;
+}
+
+template <typename Rules>
+void BasicGame<Rules>::unmakeTurn(const BasicGameState<Rules>& undo){
+    state = undo;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getWinner() const{
+    //The winner is the only player who has not lost
+    int winner = -1;
+    for(int i = 0; i < state.playerCount; i++){
+        if(state.players[i].lost) continue;
+        if(winner != -1) return -1;
+        winner = i;
+    }
+    return state.gameOver ? winner : -1;
+}
+
+template <typename Rules>
+EndReason BasicGame<Rules>::getEndReason() const{
+    return state.endReason;
+}
+
+template <typename Rules>
+char BasicGame<Rules>::getCell(int x, int y) const{
+    return cellChar(x, y);
+}
+
+template <typename Rules>
+const typename Rules::Cells::Grid& BasicGame<Rules>::getCrystalCells() const{
+    return state.crystals;
+}
+
+template <typename Rules>
+const typename Rules::Cells::Grid& BasicGame<Rules>::getObstacleCells() const{
+    return cells.obstacles;
+}
+
+template <typename Rules>
+const std::vector<std::pair<int, int>>& BasicGame<Rules>::getChangedCells() const requires (Rules::SPARSE){
+    return changedCells;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getTotalCrystals() const{
+    return state.totalCrystals;
+}
+
+template <typename Rules>
+bool BasicGame<Rules>::isGameOver() const{
+    return state.gameOver;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getCurrentTurn() const{
+    return state.currentTurn;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getPlayerCount() const{
+    return state.playerCount;
+}
+
+template <typename Rules>
+const PlayerState& BasicGame<Rules>::getPlayer(int player) const{
+    return state.players[player];
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getX(int player) const{
+    return state.players[player].x;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getY(int player) const{
+    return state.players[player].y;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getHP(int player) const{
+    return state.players[player].hp;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getCrystals(int player) const{
+    return state.players[player].crystals;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getBombCooldown(int player) const{
+    return state.players[player].bombCooldown;
+}
+
+template <typename Rules>
+int BasicGame<Rules>::getAttackCooldown(int player) const{
+    return state.players[player].attackCooldown;
+}
+
+template <typename Rules>
+Direction BasicGame<Rules>::getLastMove(int player) const{
+    return state.players[player].lastMove;
+}
+
+template <typename Rules>
+std::uint64_t BasicGame<Rules>::getHash() const{
+    return state.hash;
+}
+
+template <typename Rules>
+std::uint64_t BasicGame<Rules>::computeHash() const{
+    std::uint64_t hash = 0;
+    state.crystals.forEach([&hash](int x, int y){
+        hash ^= zobrist<Rules>.crystal[cellIndex<Rules>(x, y)];
+    });
+    for(int player = 0; player < state.playerCount; player++){
+        hash ^= zobrist<Rules>.position[player][cellIndex<Rules>(getX(player), getY(player))];
+        hash ^= zobrist<Rules>.hp[player][getHP(player)];
+        hash ^= zobrist<Rules>.crystals[player][getCrystals(player)];
+        hash ^= zobrist<Rules>.bombCooldown[player][getBombCooldown(player)];
+        hash ^= zobrist<Rules>.attackCooldown[player][getAttackCooldown(player)];
+        if(state.players[player].lost) hash ^= zobrist<Rules>.lost[player];
+    }
+    hash ^= zobrist<Rules>.totalCrystals[state.totalCrystals];
+    hash ^= zobrist<Rules>.turn[state.currentTurn];
+    return hash;
+}
+
+template Bitboard<StandardRules::GRID_SIZE> computeExplosionArea<StandardRules>(const Bitboard<StandardRules::GRID_SIZE>&, int, int);
+template Bitboard<Rules32::GRID_SIZE> computeExplosionArea<Rules32>(const Bitboard<Rules32::GRID_SIZE>&, int, int);
+template Bitboard<Rules64::GRID_SIZE> computeExplosionArea<Rules64>(const Bitboard<Rules64::GRID_SIZE>&, int, int);
+
+template class BasicGame<StandardRules>;
+template class BasicGame<Rules32>;
+template class BasicGame<Rules64>;
+template class BasicGame<RulesLarge>;
@@ -0,0 +1,129 @@
+#include "../include/log_writer.h"
+#include "../include/binary_log.h"
+#include "../include/nlohmann_json.hpp"
+
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <utility>
+
+JsonLogWriter::JsonLogWriter(std::string logsPath)
+: path {logsPath}
+{
+}
+
+JsonLogWriter::~JsonLogWriter(){
+    if(file.is_open()){
+        finish();
+    }
+}
+
+void JsonLogWriter::write(const std::string& key, const json& value){
+    if(finished){
+        return;
+    }
+    if(!file.is_open()){
+        file.open(path);
+        if(!file.is_open()){
+            std::cerr << "Error opening logs file: " << path << std::endl;
+            finished = true;
+            return;
+        }
+        file << '{';
+    }
+
+    //Pretty print with 4 spaces, indented by one more level to sit inside the object
+    std::string entry = value.dump(4);
+    std::string indented;
+    indented.reserve(entry.size() + entry.size() / 8);
+    for(char c : entry){
+        indented += c;
+        if(c == '\n'){
+            indented += "    ";
+        }
+    }
+
+    file << (empty ? "\n    " : ",\n    ") << json(key).dump() << ": " << indented;
+    file.flush();
+    empty = false;
+}
+
+void JsonLogWriter::writeGrid(const std::string& grid, int){
+    write("grid", grid);
+}
+
+void JsonLogWriter::writeTurn(const TurnRecord& turn){
+    write("Turn " + std::to_string(turn.turn), turnToJson(turn));
+}
+
+void JsonLogWriter::finish(){
+    if(finished){
+        return;
+    }
+    finished = true;
+    if(file.is_open()){
+        file << "\n}";
+        file.close();
+    }
+}
+
+json JsonLogWriter::turnToJson(const TurnRecord& turn){
+    json turnJson;
+
+    for(std::size_t i = 0; i < turn.players.size(); ++i){
+        const PlayerRecord& player = turn.players[i];
+        json& playerJson = turnJson["Player " + std::to_string(i + 1)];
+
+        //If error in the input format or while reading the input then set all moves to "ERROR"
+        if(player.readError){
+            playerJson = {
+                {"MOVE", "ERROR"},
+                {"BOMB", "ERROR"},
+                {"ATTACK", "ERROR"}
+            };
+        }
+        else{
+            playerJson = {
+                {"MOVE", directionName(player.move.dir)},
+                {"BOMB", std::make_pair(player.move.bombX, player.move.bombY)},
+                {"ATTACK", std::make_pair(player.move.attackX, player.move.attackY)}
+            };
+        }
+        //Add other details of the turn
+        playerJson["Position"] = std::make_pair(player.x, player.y);
+        playerJson["HP"] = player.hp;
+        playerJson["Crystals"] = player.crystals;
+        playerJson["Attack cooldown"] = player.attackCooldown;
+        playerJson["Bomb cooldown"] = player.bombCooldown;
+        playerJson["Response time (ms)"] = static_cast<double>(player.responseTime.count()) / 1000.0;
+        playerJson["CPU time (ms)"] = static_cast<double>(player.cpuTime.count()) / 1000.0;
+        playerJson["Write syscalls"] = player.writeSyscalls;
+        if(turn.players.size() > 2){
+            playerJson["Eliminated"] = player.eliminated;
+        }
+    }
+
+    //Check if game over to add the end reason and winner
+    if(turn.gameOver){
+        turnJson["Game status"] = "Game Over";
+        turnJson["End reason"] = turn.endReason;
+        if(turn.winner == -1){
+            turnJson["Winner"] = "None (Tie)";
+        }
+        else{
+            turnJson["Winner"] = "Player " + std::to_string(turn.winner + 1);
+        }
+    }
+    else{
+        turnJson["Game status"] = "Ongoing";
+    }
+    return turnJson;
+}
+
+std::unique_ptr<LogWriter> makeLogWriter(const std::string& path){
+    if(path.ends_with(binaryLogExtension)){
+        return std::make_unique<BinaryLogWriter>(path);
+    }
+    return std::make_unique<JsonLogWriter>(path);
+}
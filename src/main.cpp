@@ -1,130 +1,213 @@
-#include <boost/process.hpp>
-#include <boost/asio.hpp>
-#include <boost/system.hpp>
-
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <array>
-#include <optional>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <csignal>
+#include <thread>
+#include <algorithm>
+#include <charconv>
+#include <limits>
 
 #include "../include/util.h"
-#include "../include/engine.h"
-
-namespace bp = boost::process;
-namespace asio = boost::asio;
-
-void abortProgram(Engine& engine, bp::child& bot1, bp::child& bot2);
-void handleTurn(Engine& engine, bp::child& bot1, bp::child& bot2,
-    bp::async_pipe& bot1_out, bp::async_pipe& bot2_out);
-
-int main(int argc, char* argv[]){
-    //Usage: ./engine bot1.cpp bot2.cpp logs_file.json(optional)
-
-    if(argc != 3 && argc != 4){
-        std::cerr << "Usage: ./engine path_to_bot1.cpp path_to_bot2.cpp logs_file.json(optional) \n";
-        std::exit(1);
+#include "../include/game.h"
+#include "../include/match.h"
+#include "../include/tournament.h"
+
+namespace {
+
+void printUsage(){
+    std::cerr << "Usage: ./engine [--time-limit-ms N] [--timeout-clock cpu|wall] [--grid-size N] [--shm-bots LIST] [--plugin-bots LIST] path_to_bot1.cpp path_to_bot2.cpp [bot3.cpp ...] logs_file(optional, .json or .cglog) \n"
+              << "       ./engine tournament [--threads N] [--seeds N] [--seed BASE] [--out DIR] "
+                 "[--time-limit-ms N] [--timeout-clock cpu|wall] [--log-format json|binary] [--players N] [--grid-size N] "
+                 "[--bot-processes per-match|pooled] [--matches-per-core N] [--shm-bots LIST] [--plugin-bots LIST] bot1.cpp bot2.cpp [bot3.cpp ...]\n"
+              << "More than two bots in a match play a free-for-all, at most " << MAX_PLAYERS << " bots\n"
+              << "--timeout-clock cpu (the default) judges the time limit on the CPU time of the bots, "
+                 "with a wall-clock backstop, wall on the time elapsed\n"
+              << "--matches-per-core N splits the cores into sets of one per bot of a match and one for the engine "
+                 "(one set of them all if there are too few), shared by the matches of N threads\n"
+              << "--shm-bots offers shared memory to the bots numbered in LIST (e.g. 1,3), in the order they are given "
+                 "(from 1 to the number of bots)\n"
+              << "--plugin-bots builds the bots numbered in LIST as plugins (see include/bot_plugin.h) called by the engine, "
+                 "a plugin that misses the time limit is not called again. A bot cannot be in both lists\n"
+              << "The grid size is one of";
+    for(int size : GRID_SIZES){
+        std::cerr << ' ' << size;
     }
+    std::cerr << " (default " << GRID_SIZE << ")\n";
+}
 
-    buildCpp(argv[1], "bot1");
-    buildCpp(argv[2], "bot2");
-
-    asio::io_context ctx1;
-    asio::io_context ctx2;
-    
-    bp::async_pipe bot1_out{ctx1}, bot2_out{ctx2};
-    bp::opstream bot1_in, bot2_in;
+//True if there are rules for a grid of `size` (see rules.h)
+bool isGridSize(int size){
+    return std::find(GRID_SIZES.begin(), GRID_SIZES.end(), size) != GRID_SIZES.end();
+}
 
-    
-    bp::child bot1("bin/bot1", bp::std_out > bot1_out, bp::std_in < bot1_in, ctx1);
-    bp::child bot2("bin/bot2", bp::std_out > bot2_out, bp::std_in < bot2_in, ctx2);
+//Parses `value` as a whole number from `min` to `max` into `number`.
+//Returns false, leaving `number` unchanged, if it is not one.
+template <typename T>
+bool parseNumber(std::string_view value, T min, T max, T& number){
+    T parsed {};
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if(value.empty() || ec != std::errc() || ptr != value.data() + value.size() || parsed < min || parsed > max){
+        return false;
+    }
+    number = parsed;
+    return true;
+}
 
-    Engine engine = (argc == 4) ? Engine(argv[3]) : Engine(); //Fixed seed for debugging
+//Parses a time limit in milliseconds (at least 1) into `limit`
+bool parseTimeLimit(std::string_view value, std::chrono::milliseconds& limit){
+    int ms = 0;
+    if(!parseNumber(value, 1, std::numeric_limits<int>::max(), ms)){
+        return false;
+    }
+    limit = std::chrono::milliseconds(ms);
+    return true;
+}
 
-    //First turn - send just the game state and grid to both bots    
-    bot1_in << engine.getGameState(0) << std::endl;
-    bot2_in << engine.getGameState(1) << std::endl;
+//Parses a grid size that there are rules for (see rules.h) into `size`
+bool parseGridSize(std::string_view value, int& size){
+    int parsed = 0;
+    if(!parseNumber(value, 1, std::numeric_limits<int>::max(), parsed) || !isGridSize(parsed)){
+        return false;
+    }
+    size = parsed;
+    return true;
+}
 
-    std::array<std::array<char, GRID_SIZE>, GRID_SIZE> grid = engine.getGrid();
-    for(int i = 0; i < GRID_SIZE; ++i){
-        for(int j = 0; j < GRID_SIZE; ++j){
-            bot1_in << grid[i][j];
-            bot2_in << grid[i][j];
+//Parses a list of bot numbers such as "1,3" (counting from 1) into `bots`, bots[i] being set
+//for bot i + 1. Returns false if it is not such a list of bots out of the `count` given.
+bool parseBotList(const std::string& list, std::size_t count, std::vector<bool>& bots){
+    std::size_t start = 0;
+    while(start <= list.size()){
+        std::size_t end = std::min(list.find(',', start), list.size());
+        std::size_t number = 0;
+        std::string_view item(list.data() + start, end - start);
+        if(!parseNumber(item, std::size_t{1}, count, number)){
+            return false;
+        }
+        std::size_t index = number - 1;
+        if(bots.size() <= index){
+            bots.resize(index + 1);
         }
-        bot1_in << std::endl;
-        bot2_in << std::endl;
+        bots[index] = true;
+        start = end + 1;
     }
+    return true;
+}
 
-    engine.printGrid(); //For debugging
-    std::cout << "--------------------------------------------" << std::endl;
-
-    handleTurn(engine, bot1, bot2, bot1_out, bot2_out);
-    
-    while(bot1.running() && bot2.running()){
-        engine.printGrid(); //For debugging
-        std::cout << "--------------------------------------------" << std::endl;
-
-        //Send the last move made by the opponent
-        bot1_in << "MOVE " << engine.getLastMove(1) << std::endl;
-        bot2_in << "MOVE " << engine.getLastMove(0) << std::endl;
-
-        bot1_in << engine.getGameState(0) << std::endl;
-        bot2_in << engine.getGameState(1) << std::endl;
+//True if a bot is in both lists parsed by parseBotList()
+bool listedTwice(const std::vector<bool>& bots, const std::vector<bool>& others){
+    for(std::size_t i = 0; i < std::min(bots.size(), others.size()); ++i){
+        if(bots[i] && others[i]){
+            return true;
+        }
+    }
+    return false;
+}
 
-        //Send the updated grid to both bots
-        grid = engine.getGrid();
-        for(int i = 0; i < GRID_SIZE; ++i){
-            for(int j = 0; j < GRID_SIZE; ++j){
-                bot1_in << grid[i][j];
-                bot2_in << grid[i][j];
+//Splits the arguments starting at argv[first] into `--option value` pairs and positional arguments.
+//Returns false if an option is missing its value.
+bool parseArgs(int argc, char* argv[], int first,
+    std::vector<std::pair<std::string_view, std::string>>& options, std::vector<std::string>& positional){
+    for(int i = first; i < argc; ++i){
+        std::string_view arg = argv[i];
+        if(arg.starts_with("--")){
+            if(i + 1 >= argc){
+                return false;
             }
-            bot1_in << std::endl;
-            bot2_in << std::endl;
+            options.emplace_back(arg, argv[++i]);
+        }
+        else{
+            positional.emplace_back(arg);
         }
-
-        handleTurn(engine, bot1, bot2, bot1_out, bot2_out);        
     }
-    
-    bot1.wait();
-    bot2.wait();
-    return 0;
+    return true;
 }
 
-void abortProgram(Engine& engine, bp::child& bot1, bp::child& bot2){
-    engine.printEndReason();
-    bot1.terminate();
-    bot2.terminate();
-    bot1.wait();
-    bot2.wait();
-    std::exit(0);
+int tournamentMain(int argc, char* argv[]){
+    TournamentConfig config;
+    config.threads = std::thread::hardware_concurrency();
+
+    std::vector<std::pair<std::string_view, std::string>> options;
+    if(!parseArgs(argc, argv, 2, options, config.botSources)){
+        printUsage();
+        return 1;
+    }
+    for(const auto& [option, value] : options){
+        if(option == "--threads" && parseNumber(value, 1u, std::numeric_limits<unsigned>::max(), config.threads)) continue;
+        else if(option == "--seeds" && parseNumber(value, 1, std::numeric_limits<int>::max(), config.seeds)) continue;
+        else if(option == "--seed" && parseNumber(value, 0u, std::numeric_limits<unsigned>::max(), config.baseSeed)) continue;
+        else if(option == "--out") config.outDir = value;
+        else if(option == "--time-limit-ms" && parseTimeLimit(value, config.responseTimeLimit)) continue;
+        else if(option == "--timeout-clock" && (value == "cpu" || value == "wall")) config.timeoutClock = (value == "wall" ? TimeoutClock::WALL : TimeoutClock::CPU);
+        else if(option == "--log-format" && (value == "json" || value == "binary")) config.binaryLogs = (value == "binary");
+        else if(option == "--players" && parseNumber(value, 2, MAX_PLAYERS, config.players)) continue;
+        else if(option == "--grid-size" && parseGridSize(value, config.gridSize)) continue;
+        else if(option == "--bot-processes" && (value == "per-match" || value == "pooled")) config.reuseBots = (value == "pooled");
+        else if(option == "--matches-per-core" && parseNumber(value, 1, std::numeric_limits<int>::max(), config.matchesPerCore)) continue;
+        else if(option == "--shm-bots" && parseBotList(value, config.botSources.size(), config.sharedMemory)) continue;
+        else if(option == "--plugin-bots" && parseBotList(value, config.botSources.size(), config.plugins)) continue;
+        else{
+            printUsage();
+            return 1;
+        }
+    }
+    if(listedTwice(config.sharedMemory, config.plugins)){
+        printUsage();
+        return 1;
+    }
+    return runTournament(config);
 }
 
-void handleTurn(Engine& engine, bp::child& bot1, bp::child& bot2,
-    bp::async_pipe& bot1_out, bp::async_pipe& bot2_out){
+} // namespace
 
-    auto& ctx1 = (asio::io_context&) bot1_out.get_executor().context();
-    auto& ctx2 = (asio::io_context&) bot2_out.get_executor().context();
+int main(int argc, char* argv[]){
+    //Usage: ./engine [options] bot1.cpp bot2.cpp [bot3.cpp ...] logs_file.json(optional)
+    //       ./engine tournament [options] bot1.cpp bot2.cpp ...
 
-    //Asynchronously read input from the bots but give them limited time to respond
-    std::optional<std::string> bot1Output = readPipeDeadline(
-        bot1_out, ctx1, boost::posix_time::seconds(responseTimeLimit)
-    );
-    std::optional<std::string> bot2Output= readPipeDeadline(
-        bot2_out, ctx2, boost::posix_time::seconds(responseTimeLimit)
-    );
-    bool bot1ReadError = !bot1Output.has_value();
-    bool bot2ReadError = !bot2Output.has_value();
+    //A bot dying mid-game must not take the engine down with it
+    std::signal(SIGPIPE, SIG_IGN);
 
-    if(bot1ReadError || bot2ReadError){
-        std::cerr << "Error reading input after "
-        << engine.getCurrentTurn() << " turn" << std::endl;
+    if(argc >= 2 && std::string_view(argv[1]) == "tournament"){
+        return tournamentMain(argc, argv);
+    }
 
-        engine.outputReadError(bot1ReadError, bot2ReadError);
-        abortProgram(engine, bot1, bot2);
+    MatchConfig config;
+    std::vector<std::pair<std::string_view, std::string>> options;
+    std::vector<std::string> positional;
+    if(!parseArgs(argc, argv, 1, options, positional)){
+        printUsage();
+        std::exit(1);
+    }
+    //Every .cpp file is a bot, a last argument that is not is the logs file
+    if(!positional.empty() && !positional.back().ends_with(".cpp")){
+        config.logsPath = positional.back();
+        positional.pop_back();
+    }
+    if(positional.size() < 2 || positional.size() > static_cast<std::size_t>(MAX_PLAYERS)){
+        printUsage();
+        std::exit(1);
+    }
+    for(const auto& [option, value] : options){
+        if(option == "--time-limit-ms" && parseTimeLimit(value, config.responseTimeLimit)) continue;
+        else if(option == "--timeout-clock" && (value == "cpu" || value == "wall")) config.timeoutClock = (value == "wall" ? TimeoutClock::WALL : TimeoutClock::CPU);
+        else if(option == "--grid-size" && parseGridSize(value, config.gridSize)) continue;
+        else if(option == "--shm-bots" && parseBotList(value, positional.size(), config.sharedMemory)) continue;
+        else if(option == "--plugin-bots" && parseBotList(value, positional.size(), config.plugins)) continue;
+        else{
+            printUsage();
+            std::exit(1);
+        }
+    }
+    if(listedTwice(config.sharedMemory, config.plugins)){
+        printUsage();
+        std::exit(1);
     }
 
-    engine.processTurn(bot1Output.value(), bot2Output.value());
-    if(engine.isGameOver()){
-        abortProgram(engine, bot1, bot2);
+    for(std::size_t i = 0; i < positional.size(); ++i){
+        config.botPaths.push_back(buildCpp(positional[i], i < config.plugins.size() && config.plugins[i]));
     }
-}
\ No newline at end of file
+    playMatch(config);
+    return 0;
+}
@@ -0,0 +1,385 @@
+#include <boost/process.hpp>
+#include <boost/asio.hpp>
+
+#include <iostream>
+#include <string>
+#include <array>
+#include <optional>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <iterator>
+#include <utility>
+#include <cstdio>
+
+#include "../include/match.h"
+#include "../include/util.h"
+#include "../include/engine.h"
+#include "../include/bot_pool.h"
+#include "../include/shm_channel.h"
+#include "../include/plugin_bot.h"
+
+namespace bp = boost::process;
+namespace asio = boost::asio;
+
+namespace {
+
+using Bots = std::vector<std::unique_ptr<BotProcess>>; //Null for the plugins
+
+//A bot plugin and what it is given, reused from one turn to the next
+struct PluginSeat{
+    std::unique_ptr<PluginBot> bot; //Null if the player is a process
+    BotObservation observation {};
+    std::string grid;
+    std::vector<std::int32_t> changes;
+};
+
+//How long the bots are waited for in a turn: the time limit, or its backstop if it is judged on CPU time
+std::chrono::milliseconds turnWallLimit(const MatchConfig& config){
+    return config.timeoutClock == TimeoutClock::CPU ? wallClockBackstop(config.responseTimeLimit) : config.responseTimeLimit;
+}
+
+//Sends the observation for this turn to every bot still in the game.
+//Each observation is built in one buffer (reused across turns) and delivered with
+//a single write, the number of write syscalls is recorded in the logs.
+//Bots using shared memory are sent their frames through it, without a syscall unless they sleep.
+//Bots that already played a game are told a new one starts on its first turn.
+//Plugins are called then, on their threads, with their BotObservation.
+//The pipes are written to without blocking: a bot that does not read its observation is not waited for
+//past `wallLimit`, and sets unsent[i] (as does a bot whose pipe or shared memory could not take it).
+//Returns the time at which the observations started being sent, and the CPU time of the bots then in `cpuTimes`.
+template <typename Rules>
+std::chrono::steady_clock::time_point sendObservations(BasicEngine<Rules>& engine, Bots& bots,
+    std::vector<PluginSeat>& plugins, std::vector<std::string>& buffers, bool firstTurn, std::chrono::milliseconds wallLimit,
+    std::array<std::chrono::nanoseconds, MAX_PLAYERS>& cpuTimes, std::array<bool, MAX_PLAYERS>& unsent){
+    for(int player = 0; player < engine.getPlayerCount(); ++player){
+        std::size_t i = static_cast<std::size_t>(player);
+        std::string& buffer = buffers[i];
+        buffer.clear();
+        if(plugins[i].bot && !engine.isEliminated(player)){
+            engine.getPluginObservation(player, firstTurn, plugins[i].observation, plugins[i].grid, plugins[i].changes);
+        }
+        if(!bots[i]){
+            continue;
+        }
+        if(firstTurn && bots[i]->gamesPlayed > 0){
+            std::string_view emptyFrame("\0\0\0\0", sizeof(std::uint32_t));
+            if(bots[i]->sharedMemoryFrames){
+                bots[i]->channel->send(emptyFrame);
+            }
+            else if(bots[i]->framed){
+                buffer += emptyFrame;
+            }
+            buffer += "NEWGAME\n";
+        }
+        if(!engine.isEliminated(player)){
+            engine.appendObservation(buffer, player, firstTurn);
+        }
+    }
+    for(std::size_t i = 0; i < bots.size(); ++i){
+        if(bots[i]){
+            cpuTimes[i] = cpuTime(bots[i]->cpuClock);
+        }
+    }
+    auto sentAt = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < plugins.size(); ++i){
+        if(plugins[i].bot && !engine.isEliminated(static_cast<int>(i))){
+            plugins[i].bot->call(plugins[i].observation);
+        }
+    }
+    std::array<int, MAX_PLAYERS> syscalls {};
+    std::vector<bp::pipe*> pipes;
+    std::vector<std::string_view> observations;
+    std::vector<std::size_t> pipePlayers; //pipePlayers[k] is sent observations[k] through pipes[k]
+    for(int player = 0; player < engine.getPlayerCount(); ++player){
+        std::size_t i = static_cast<std::size_t>(player);
+        if(!engine.isEliminated(player) && bots[i]){
+            if(!firstTurn && engine.usesSharedMemory(player)){
+                syscalls[i] = bots[i]->channel->send(buffers[i]) ? 0 : -1;
+            }
+            else{
+                pipes.push_back(&bots[i]->in);
+                observations.push_back(buffers[i]);
+                pipePlayers.push_back(i);
+            }
+        }
+    }
+    std::vector<int> pipeSyscalls = writePipesDeadline(pipes, observations, sentAt + wallLimit);
+    for(std::size_t k = 0; k < pipePlayers.size(); ++k){
+        syscalls[pipePlayers[k]] = pipeSyscalls[k];
+    }
+    for(int player = 0; player < engine.getPlayerCount(); ++player){
+        std::size_t i = static_cast<std::size_t>(player);
+        unsent[i] = !engine.isEliminated(player) && bots[i] && syscalls[i] == -1;
+        if(unsent[i]){
+            std::cerr << "Write error: the observation of Player " << player + 1 << " could not be delivered\n";
+        }
+    }
+    engine.setWriteSyscalls(syscalls);
+    return sentAt;
+}
+
+//Reads the moves of the bots still in the game, then calls the plugins, and plays the turn.
+//`cpuTimes` are the CPU times of the bots when they were sent their observations.
+//Adds the time each bot took to answer to `responseTimesPerTurn`.
+//Sets faulted[i] if no move could be read from bots[i], as for the bots with unsent[i] which are not read from.
+//Returns true if the game is over.
+template <typename Rules>
+bool handleTurn(BasicEngine<Rules>& engine, asio::io_context& ctx, std::chrono::steady_clock::time_point sentAt,
+    const std::array<std::chrono::nanoseconds, MAX_PLAYERS>& cpuTimes, const std::array<bool, MAX_PLAYERS>& unsent,
+    Bots& bots, std::vector<PluginSeat>& plugins,
+    const MatchConfig& config, std::vector<std::vector<std::chrono::microseconds>>& responseTimesPerTurn,
+    std::array<bool, MAX_PLAYERS>& faulted){
+
+    //With TimeoutClock::CPU the bots are judged on their CPU time, the wall clock only being a backstop
+    std::optional<std::chrono::milliseconds> cpuLimit;
+    std::chrono::milliseconds wallLimit = turnWallLimit(config);
+    if(config.timeoutClock == TimeoutClock::CPU){
+        cpuLimit = config.responseTimeLimit;
+    }
+
+    std::vector<bp::async_pipe*> pipes;
+    std::vector<bool> framed;
+    CpuBudget pipesCpu {{}, {}, cpuLimit}, channelsCpu {{}, {}, cpuLimit};
+    std::vector<ShmChannel*> channels;
+    std::vector<std::size_t> players, channelPlayers; //players[k] sent replies[k], channelPlayers[k] channelReplies[k]
+    for(int player = 0; player < engine.getPlayerCount(); ++player){
+        std::size_t i = static_cast<std::size_t>(player);
+        if(engine.isEliminated(player) || !bots[i] || unsent[i]){
+            continue;
+        }
+        if(engine.getCurrentTurn() > 0 && engine.usesSharedMemory(player)){
+            channels.push_back(bots[i]->channel.get());
+            channelPlayers.push_back(i);
+            channelsCpu.clocks.push_back(bots[i]->cpuClock);
+            channelsCpu.startTimes.push_back(cpuTimes[i]);
+            continue;
+        }
+        pipes.push_back(&bots[i]->out);
+        pipesCpu.clocks.push_back(bots[i]->cpuClock);
+        pipesCpu.startTimes.push_back(cpuTimes[i]);
+        framed.push_back(engine.getCurrentTurn() > 0 && engine.usesBinaryProtocol(player));
+        players.push_back(i);
+    }
+
+    //Asynchronously read input from all bots at once but give them limited time to respond.
+    //The bots on shared memory are waited for on this thread, and the pipes on another one if there are both.
+    std::vector<PipeReply> replies, channelReplies;
+    if(channels.empty()){
+        if(!pipes.empty()){ //With only plugins left there is nothing to wait for here
+            replies = readPipesDeadline(pipes, ctx, sentAt, wallLimit, framed, &pipesCpu);
+        }
+    }
+    else if(pipes.empty()){
+        channelReplies = readChannelsDeadline(channels, sentAt, wallLimit, &channelsCpu);
+    }
+    else{
+        std::thread pipeReader([&](){
+            replies = readPipesDeadline(pipes, ctx, sentAt, wallLimit, framed, &pipesCpu);
+        });
+        channelReplies = readChannelsDeadline(channels, sentAt, wallLimit, &channelsCpu);
+        pipeReader.join();
+    }
+    replies.insert(replies.end(), std::make_move_iterator(channelReplies.begin()),
+                   std::make_move_iterator(channelReplies.end()));
+    players.insert(players.end(), channelPlayers.begin(), channelPlayers.end());
+
+    //The bots that were not sent their whole observation get no move
+    for(std::size_t i = 0; i < unsent.size(); ++i){
+        if(unsent[i]){
+            PipeReply& reply = replies.emplace_back();
+            reply.latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sentAt);
+            players.push_back(i);
+        }
+    }
+
+    //The plugins were called with the observations sent and have the same deadline,
+    //what is left of it once the processes have answered
+    for(std::size_t i = 0; i < plugins.size(); ++i){
+        PluginSeat& plugin = plugins[i];
+        if(!plugin.bot || engine.isEliminated(static_cast<int>(i))){
+            continue;
+        }
+        replies.push_back(plugin.bot->wait(sentAt, wallLimit, cpuLimit));
+        players.push_back(i);
+    }
+
+    std::array<std::string_view, MAX_PLAYERS> inputs {};
+    std::array<bool, MAX_PLAYERS> readErrors {};
+    std::array<std::chrono::microseconds, MAX_PLAYERS> responseTimes {}, usedCpu {};
+    bool anyReadError = false;
+    for(std::size_t k = 0; k < replies.size(); ++k){
+        std::size_t player = players[k];
+        responseTimes[player] = replies[k].latency;
+        responseTimesPerTurn[player].push_back(replies[k].latency);
+        usedCpu[player] = replies[k].cpuTime;
+        if(replies[k].line.has_value()){
+            inputs[player] = replies[k].line.value();
+        }
+        else{
+            readErrors[player] = true;
+            faulted[player] = true;
+            anyReadError = true;
+        }
+    }
+
+    engine.setResponseTimes(responseTimes);
+    engine.setCpuTimes(usedCpu);
+
+    if(anyReadError){
+        if(config.verbose){
+            std::cerr << "Error reading input after "
+            << engine.getCurrentTurn() << " turn" << std::endl;
+        }
+        engine.outputReadError(readErrors);
+        if(engine.isGameOver()){
+            return true;
+        }
+        //A free-for-all goes on with the moves of the others
+    }
+
+    engine.processTurn(inputs);
+    return engine.isGameOver();
+}
+
+template <typename Rules>
+MatchResult playMatchWithRules(const MatchConfig& config){
+    const std::size_t players = config.botPaths.size();
+
+    //One event loop for all bots so that their replies are awaited together,
+    //the pool's if the bots come from one
+    std::optional<asio::io_context> ownContext;
+    asio::io_context& ctx = config.pool ? config.pool->context() : ownContext.emplace();
+
+    //The thread playing the match, and each bot below, only run on their own core of config.cpus
+    auto coreOf = [&config](std::size_t seat){
+        return std::vector<int>{config.cpus[seat % config.cpus.size()]};
+    };
+    if(!config.cpus.empty() && !pinToCpus(0, coreOf(players))){
+        perror("sched_setaffinity");
+    }
+
+    Bots bots(players);
+    std::vector<PluginSeat> plugins(players);
+    for(std::size_t i = 0; i < players; ++i){
+        const std::string& path = config.botPaths[i];
+        if(i < config.plugins.size() && config.plugins[i]){
+            plugins[i].bot = std::make_unique<PluginBot>(path);
+            if(!config.cpus.empty() && !plugins[i].bot->pinToCpus(coreOf(i))){
+                perror("pthread_setaffinity_np");
+            }
+            continue;
+        }
+        bool sharedMemory = i < config.sharedMemory.size() && config.sharedMemory[i];
+        bots[i] = config.pool ? config.pool->acquire(path, sharedMemory)
+                              : std::make_unique<BotProcess>(path, ctx, sharedMemory);
+        if(!config.cpus.empty() && !pinToCpus(bots[i]->child.id(), coreOf(i))){
+            perror("sched_setaffinity");
+        }
+    }
+
+    BasicEngine<Rules> engine(config.logsPath, config.seed.value_or(static_cast<unsigned>(std::time(nullptr))),
+                             static_cast<int>(players));
+    for(std::size_t i = 0; i < players; ++i){
+        if(plugins[i].bot){
+            engine.usePlugin(static_cast<int>(i));
+        }
+        else if(bots[i]->channel){
+            engine.offerSharedMemory(static_cast<int>(i));
+        }
+    }
+
+    std::vector<std::string> buffers(players);
+
+    std::array<bool, MAX_PLAYERS> faulted {}; //No move could be read from the bot at some point
+    std::vector<std::vector<std::chrono::microseconds>> responseTimes(players);
+
+    bool firstTurn = true;
+    bool gameOver = false;
+    while(!gameOver){
+        if(!firstTurn){
+            //A bot exited right after sending its move
+            std::array<bool, MAX_PLAYERS> exited {};
+            bool anyExited = false;
+            for(int player = 0; player < engine.getPlayerCount(); ++player){
+                const std::unique_ptr<BotProcess>& bot = bots[static_cast<std::size_t>(player)];
+                if(!engine.isEliminated(player) && bot && !bot->child.running()){
+                    exited[static_cast<std::size_t>(player)] = true;
+                    faulted[static_cast<std::size_t>(player)] = true;
+                    anyExited = true;
+                }
+            }
+            if(anyExited){
+                //In a free-for-all that goes on, the others then play the turn
+                engine.outputReadError(exited);
+                gameOver = engine.isGameOver();
+                continue;
+            }
+        }
+
+        if(config.verbose){
+            engine.printGrid(); //For debugging
+            std::cout << "--------------------------------------------" << std::endl;
+        }
+
+        //Send the last move made by the opponent (except on the first turn), the game state and the grid
+        std::array<std::chrono::nanoseconds, MAX_PLAYERS> cpuTimes {};
+        std::array<bool, MAX_PLAYERS> unsent {};
+        auto sentAt = sendObservations(engine, bots, plugins, buffers, firstTurn, turnWallLimit(config), cpuTimes, unsent);
+        firstTurn = false;
+
+        gameOver = handleTurn(engine, ctx, sentAt, cpuTimes, unsent, bots, plugins, config, responseTimes, faulted);
+
+        //Bots knocked out of a free-for-all are stopped straight away
+        for(std::size_t i = 0; i < players && !gameOver; ++i){
+            if(engine.isEliminated(static_cast<int>(i)) && bots[i]){
+                bots[i]->child.terminate();
+            }
+        }
+    }
+
+    if(config.verbose){
+        engine.printEndReason();
+    }
+    //Bots that can play another game go back to the pool, unless they may be in the middle
+    //of sending a move (they timed out) or are gone
+    for(std::size_t i = 0; i < players; ++i){
+        int player = static_cast<int>(i);
+        if(!bots[i]){
+            continue;
+        }
+        if(config.pool && engine.isMultiGame(player) && !faulted[i] && bots[i]->child.running()){
+            bots[i]->gamesPlayed++;
+            bots[i]->framed = engine.usesBinaryProtocol(player);
+            bots[i]->sharedMemoryFrames = engine.usesSharedMemory(player);
+            config.pool->release(std::move(bots[i]));
+        }
+        else{
+            bots[i]->child.terminate();
+        }
+    }
+    for(std::unique_ptr<BotProcess>& bot : bots){
+        if(bot){
+            bot->child.wait();
+        }
+    }
+
+    return MatchResult{engine.getWinner(), engine.getCurrentTurn(), engine.getEndReason(), std::move(responseTimes)};
+}
+
+} // namespace
+
+MatchResult playMatch(const MatchConfig& config){
+    MatchResult result;
+    bool played = withRules(config.gridSize, [&config, &result](auto rules){
+        result = playMatchWithRules<decltype(rules)>(config);
+    });
+    if(!played){
+        result.endReason = "No rules for a grid size of " + std::to_string(config.gridSize);
+        std::cerr << result.endReason << std::endl;
+    }
+    return result;
+}
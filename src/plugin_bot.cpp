@@ -0,0 +1,207 @@
+#include "../include/plugin_bot.h"
+
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+//Loads the plugin at `path` the first time it is asked for, it is never unloaded
+const PluginBot::Library& loadLibrary(const std::string& path){
+    static std::mutex mutex;
+    static std::map<std::string, PluginBot::Library> libraries;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto loaded = libraries.find(path);
+    if(loaded != libraries.end()){
+        return loaded->second;
+    }
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if(handle == nullptr){
+        std::cerr << "Error loading bot plugin: " << dlerror() << '\n';
+        std::exit(2);
+    }
+    PluginBot::Library library;
+    void* init = dlsym(handle, "bot_init");
+    void* act = dlsym(handle, "bot_act");
+    void* free = dlsym(handle, "bot_free");
+    if(init == nullptr || act == nullptr || free == nullptr){
+        std::cerr << "Bot plugin " << path << " does not export bot_init, bot_act and bot_free\n";
+        std::exit(2);
+    }
+    //dlsym() returns data pointers, they are copied into the function pointers
+    std::memcpy(&library.init, &init, sizeof(init));
+    std::memcpy(&library.act, &act, sizeof(act));
+    std::memcpy(&library.free, &free, sizeof(free));
+    return libraries.emplace(path, library).first->second;
+}
+
+//The plugins that missed a deadline, they are not called again
+std::mutex refusedMutex;
+std::set<std::string> refused;
+
+bool isRefused(const std::string& path){
+    std::lock_guard<std::mutex> lock(refusedMutex);
+    return refused.contains(path);
+}
+
+void refuse(const std::string& path){
+    std::lock_guard<std::mutex> lock(refusedMutex);
+    if(refused.insert(path).second){
+        std::cerr << "Bot plugin " << path << " missed its deadline, it is not called again\n";
+    }
+}
+
+} // namespace
+
+struct PluginBot::Worker{
+    std::mutex mutex;
+    std::condition_variable changed;
+    void* state {};
+    clockid_t cpuClock {}; //Of the thread
+    bool called = false; //A call is waiting to be run or running
+    bool returned = false; //The last call returned, with `move` and `cpuTime`
+    bool stopping = false; //The game is over (or the plugin refused), the thread ends once no call is running
+    //The observation is copied for the thread, a call that missed its deadline may outlive the match
+    BotObservation observation {};
+    std::string grid;
+    std::vector<std::int32_t> changes;
+    BotMove move {};
+    std::chrono::nanoseconds cpuTime {};
+    std::chrono::steady_clock::time_point returnedAt;
+};
+
+void PluginBot::run(Library library, std::shared_ptr<Worker> worker){
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    while(true){
+        worker->changed.wait(lock, [&worker](){ return worker->called || worker->stopping; });
+        if(!worker->called){
+            break;
+        }
+        lock.unlock();
+        worker->move = {0, -1, -1, -1, -1};
+        auto cpuStart = cpuTime(CLOCK_THREAD_CPUTIME_ID);
+        library.act(worker->state, &worker->observation, &worker->move);
+        auto used = cpuTime(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+        auto returnedAt = std::chrono::steady_clock::now();
+        lock.lock();
+        worker->cpuTime = used;
+        worker->returnedAt = returnedAt;
+        worker->called = false;
+        worker->returned = true;
+        worker->changed.notify_all();
+        if(worker->stopping){
+            break;
+        }
+    }
+    lock.unlock();
+    library.free(worker->state);
+}
+
+PluginBot::PluginBot(const std::string& pluginPath)
+    : path(pluginPath), library(loadLibrary(pluginPath)), worker(std::make_shared<Worker>()) {
+    if(isRefused(path)){
+        return;
+    }
+    worker->state = library.init();
+    thread = std::thread(&PluginBot::run, library, worker);
+    if(pthread_getcpuclockid(thread.native_handle(), &worker->cpuClock) != 0){
+        perror("pthread_getcpuclockid");
+        std::exit(2);
+    }
+}
+
+PluginBot::~PluginBot(){
+    if(!thread.joinable()){
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->stopping = true;
+    }
+    worker->changed.notify_all();
+    thread.join();
+}
+
+void PluginBot::call(const BotObservation& observation){
+    calling = thread.joinable() && !isRefused(path);
+    if(!calling){
+        return;
+    }
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->observation = observation;
+    if(observation.grid != nullptr){
+        worker->grid.assign(observation.grid, static_cast<std::size_t>(observation.gridSize) * static_cast<std::size_t>(observation.gridSize));
+        worker->observation.grid = worker->grid.data();
+    }
+    worker->changes.assign(observation.changes, observation.changes + 3 * observation.changeCount);
+    worker->observation.changes = observation.changes != nullptr ? worker->changes.data() : nullptr;
+    callCpuStart = cpuTime(worker->cpuClock);
+    worker->called = true;
+    worker->returned = false;
+    worker->changed.notify_all();
+}
+
+PipeReply PluginBot::wait(std::chrono::steady_clock::time_point start, std::chrono::milliseconds deadline,
+                          std::optional<std::chrono::milliseconds> cpuLimit){
+    PipeReply reply;
+    if(!calling){
+        return reply; //Not called, it took no time
+    }
+    calling = false;
+
+    //Woken when the call returns, and with a CPU limit every tenth of it to check the CPU time of the thread
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    auto stopAt = start + deadline;
+    auto checkEvery = cpuLimit ? std::max(cpuLimit.value() / 10, std::chrono::milliseconds(1)) : deadline;
+    while(!worker->returned && std::chrono::steady_clock::now() < stopAt){
+        worker->changed.wait_until(lock, std::min(stopAt, std::chrono::steady_clock::now() + checkEvery));
+        if(!worker->returned && cpuLimit && cpuTime(worker->cpuClock) - callCpuStart > cpuLimit.value()){
+            break;
+        }
+    }
+
+    if(!worker->returned){
+        //The call cannot be interrupted: the thread ends when it returns, if ever, and frees the game
+        reply.latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        reply.cpuTime = std::chrono::duration_cast<std::chrono::microseconds>(cpuTime(worker->cpuClock) - callCpuStart);
+        worker->stopping = true;
+        lock.unlock();
+        thread.detach();
+        refuse(path);
+        return reply;
+    }
+    reply.latency = std::chrono::duration_cast<std::chrono::microseconds>(worker->returnedAt - start);
+    reply.cpuTime = std::chrono::duration_cast<std::chrono::microseconds>(worker->cpuTime);
+
+    if(reply.latency <= deadline && (!cpuLimit || reply.cpuTime <= cpuLimit.value())){
+        std::string& frame = reply.line.emplace(sizeof(worker->move), '\0');
+        std::memcpy(frame.data(), &worker->move, sizeof(worker->move));
+    }
+    return reply;
+}
+
+bool PluginBot::pinToCpus(const std::vector<int>& cpus){
+    if(!thread.joinable()){
+        return true; //Refused, nothing runs
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int cpu : cpus){
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+}
+
+const std::string& PluginBot::getPath() const{
+    return path;
+}
@@ -0,0 +1,108 @@
+#include "../include/shm_channel.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<unsigned> channelCount {0}; //To give every channel of the engine its own name
+
+} // namespace
+
+ShmChannel::ShmChannel()
+    : name("/cg-" + std::to_string(getpid()) + "-" + std::to_string(channelCount++)) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if(fd == -1){
+        perror("shm_open");
+        std::exit(2);
+    }
+    if(ftruncate(fd, sizeof(ShmSegment)) == -1){
+        perror("ftruncate");
+        std::exit(2);
+    }
+    void* memory = mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED){
+        perror("mmap");
+        std::exit(2);
+    }
+    segment = new (memory) ShmSegment;
+}
+
+ShmChannel::~ShmChannel(){
+    munmap(segment, sizeof(ShmSegment));
+    shm_unlink(name.c_str());
+}
+
+const std::string& ShmChannel::getName() const{
+    return name;
+}
+
+bool ShmChannel::send(std::string_view frame){
+    return shmPush(segment->toBot, frame.data(), static_cast<std::uint32_t>(frame.size()));
+}
+
+ShmRing& ShmChannel::fromBot(){
+    return segment->toEngine;
+}
+
+std::vector<PipeReply> readChannelsDeadline(const std::vector<ShmChannel*>& channels,
+                      std::chrono::steady_clock::time_point start, std::chrono::milliseconds deadline,
+                      const CpuBudget* cpu){
+    std::vector<PipeReply> replies(channels.size());
+    std::int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+    std::int64_t deadlineNs = startNs + std::chrono::duration_cast<std::chrono::nanoseconds>(deadline).count();
+    //With a CPU limit the bot waited for is checked every tenth of it
+    std::int64_t cpuCheckPeriod = deadlineNs - startNs;
+    if(cpu && cpu->limit){
+        cpuCheckPeriod = std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(cpu->limit.value()).count() / 10,
+                                                1'000'000);
+    }
+
+    for(std::size_t i = 0; i < channels.size(); ++i){
+        ShmRing& ring = channels[i]->fromBot();
+        replies[i].latency = deadline;
+        auto usedCpu = [&](){
+            return std::chrono::duration_cast<std::chrono::microseconds>(cpuTime(cpu->clocks[i]) - cpu->startTimes[i]);
+        };
+        bool answered = false, overBudget = false;
+        while(!answered && !overBudget){
+            std::int64_t waitUntil = std::min(deadlineNs, shmNow() + cpuCheckPeriod);
+            answered = shmWait(ring, waitUntil);
+            if(!answered && waitUntil == deadlineNs){
+                break;
+            }
+            overBudget = !answered && cpu && cpu->limit && usedCpu() > cpu->limit.value();
+        }
+        if(cpu){
+            replies[i].cpuTime = usedCpu();
+        }
+        if(!answered){
+            continue;
+        }
+        std::int64_t length = shmFrontLength(ring, MAX_FRAME_SIZE);
+        if(length < 0){
+            //Not a move, nor can what follows it be trusted: the bot gets no move, as from a pipe
+            std::cerr << "Read error: invalid frame in shared memory" << std::endl;
+            continue;
+        }
+        std::string& frame = replies[i].line.emplace(static_cast<std::size_t>(length), '\0');
+        shmPop(ring, frame.data(), static_cast<std::uint32_t>(length));
+        //Pushed after the observation was sent and before the engine saw it
+        std::int64_t pushedAt = std::clamp(ring.pushedAt.load(std::memory_order_relaxed), startNs, shmNow());
+        replies[i].latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(pushedAt - startNs));
+        if(cpu && cpu->limit && replies[i].cpuTime > cpu->limit.value()){
+            replies[i].line.reset();
+        }
+    }
+    return replies;
+}
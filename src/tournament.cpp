@@ -0,0 +1,272 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <cmath>
+
+#include "../include/tournament.h"
+#include "../include/match.h"
+#include "../include/util.h"
+#include "../include/log_writer.h"
+#include "../include/game.h"
+#include "../include/bot_pool.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Pairing{
+    std::vector<std::size_t> bots; //Indices into the list of bots, bots[0] plays as Player 1
+    unsigned seed;
+};
+
+//Every group of `size` bots out of `count`, in increasing order
+std::vector<std::vector<std::size_t>> combinations(std::size_t count, std::size_t size){
+    std::vector<std::vector<std::size_t>> groups;
+    std::vector<std::size_t> group(size);
+    for(std::size_t i = 0; i < size; ++i) group[i] = i;
+    while(true){
+        groups.push_back(group);
+        //Advance the last index that can still move right
+        std::size_t i = size;
+        while(i > 0 && group[i - 1] == count - size + i - 1) --i;
+        if(i == 0) return groups;
+        ++group[i - 1];
+        for(std::size_t j = i; j < size; ++j) group[j] = group[j - 1] + 1;
+    }
+}
+
+//Joins the names of the bots in `pairing` with `separator`
+std::string matchName(const std::vector<std::string>& names, const Pairing& pairing, const std::string& separator){
+    std::string name;
+    for(std::size_t bot : pairing.bots){
+        if(!name.empty()) name += separator;
+        name += names[bot];
+    }
+    return name;
+}
+
+//Splits `cpus` into disjoint sets of a core for each of the `players` bots and one for the thread
+//playing the match, or a single set of them all if there are not that many
+std::vector<std::vector<int>> splitCpus(const std::vector<int>& cpus, std::size_t players){
+    std::vector<std::vector<int>> sets;
+    std::size_t size = cpus.size() > players ? players + 1 : cpus.size();
+    for(std::size_t first = 0; size > 0 && first + size <= cpus.size(); first += size){
+        sets.emplace_back(cpus.begin() + static_cast<std::ptrdiff_t>(first),
+                          cpus.begin() + static_cast<std::ptrdiff_t>(first + size));
+    }
+    return sets;
+}
+
+struct Standing{
+    int played {}, wins {}, losses {}, ties {};
+    int points() const { return 2 * wins + ties; } //2 points for a win, 1 for a tie
+};
+
+//Spread of the times a bot took to answer over all its turns, in milliseconds
+struct LatencyStats{
+    std::size_t turns {};
+    double median {}, p99 {}, max {}, stdDev {};
+};
+
+LatencyStats latencyStats(std::vector<std::chrono::microseconds> times){
+    LatencyStats stats;
+    stats.turns = times.size();
+    if(times.empty()){
+        return stats;
+    }
+    std::sort(times.begin(), times.end());
+    auto ms = [](std::chrono::microseconds time){
+        return static_cast<double>(time.count()) / 1000.0;
+    };
+    stats.median = ms(times[times.size() / 2]);
+    stats.p99 = ms(times[times.size() * 99 / 100]);
+    stats.max = ms(times.back());
+    double mean = 0;
+    for(std::chrono::microseconds time : times){
+        mean += ms(time);
+    }
+    mean /= static_cast<double>(times.size());
+    double variance = 0;
+    for(std::chrono::microseconds time : times){
+        variance += (ms(time) - mean) * (ms(time) - mean);
+    }
+    stats.stdDev = std::sqrt(variance / static_cast<double>(times.size()));
+    return stats;
+}
+
+} // namespace
+
+int runTournament(const TournamentConfig& config){
+    const std::vector<std::string>& sources = config.botSources;
+    if(sources.size() < 2){
+        std::cerr << "A tournament needs at least two bots\n";
+        return 1;
+    }
+    if(config.players < 2 || config.players > MAX_PLAYERS ||
+       sources.size() < static_cast<std::size_t>(config.players)){
+        std::cerr << "Matches of " << config.players << " players need 2 to " << MAX_PLAYERS
+        << " players and at least as many bots\n";
+        return 1;
+    }
+
+    fs::create_directories(config.outDir);
+
+    //Build every bot exactly once, the executables are shared by all its matches
+    std::vector<std::string> names, executables;
+    for(std::size_t i = 0; i < sources.size(); ++i){
+        names.push_back(std::to_string(i + 1) + "_" + fs::path(sources[i]).stem().string());
+        executables.push_back(buildCpp(sources[i], i < config.plugins.size() && config.plugins[i]));
+    }
+
+    std::vector<Pairing> pairings;
+    std::size_t players = static_cast<std::size_t>(config.players);
+    std::vector<std::vector<std::size_t>> groups = combinations(sources.size(), players);
+    for(int s = 0; s < config.seeds; ++s){
+        unsigned seed = config.baseSeed + static_cast<unsigned>(s);
+        if(players == 2){
+            for(std::size_t i = 0; i < sources.size(); ++i){
+                for(std::size_t j = 0; j < sources.size(); ++j){
+                    if(i != j){
+                        pairings.push_back({{i, j}, seed});
+                    }
+                }
+            }
+            continue;
+        }
+        for(std::vector<std::size_t> group : groups){
+            std::rotate(group.begin(), group.begin() + static_cast<std::ptrdiff_t>(static_cast<std::size_t>(s) % players), group.end());
+            pairings.push_back({group, seed});
+        }
+    }
+
+    std::vector<MatchResult> results(pairings.size());
+    std::atomic<std::size_t> nextMatch {0};
+    std::mutex printMutex;
+
+    //With matchesPerCore, thread t plays on set of cores t / matchesPerCore (wrapping around if there are not enough sets)
+    std::vector<std::vector<int>> cpuSets = config.matchesPerCore > 0 ? splitCpus(availableCpus(), players)
+                                                                      : std::vector<std::vector<int>>();
+
+    auto worker = [&](unsigned thread){
+        //Each thread keeps its own bots, they are read on the thread's event loop
+        std::optional<BotPool> pool;
+        if(config.reuseBots){
+            pool.emplace();
+        }
+        for(std::size_t m = nextMatch++; m < pairings.size(); m = nextMatch++){
+            const Pairing& p = pairings[m];
+
+            MatchConfig matchConfig;
+            for(std::size_t bot : p.bots){
+                matchConfig.botPaths.push_back(executables[bot]);
+                matchConfig.sharedMemory.push_back(bot < config.sharedMemory.size() && config.sharedMemory[bot]);
+                matchConfig.plugins.push_back(bot < config.plugins.size() && config.plugins[bot]);
+            }
+            matchConfig.logsPath = (fs::path(config.outDir) /
+                (matchName(names, p, "_vs_") + "_seed" + std::to_string(p.seed) +
+                 (config.binaryLogs ? std::string(binaryLogExtension) : ".json"))).string();
+            matchConfig.seed = p.seed;
+            matchConfig.verbose = false;
+            matchConfig.responseTimeLimit = config.responseTimeLimit;
+            matchConfig.timeoutClock = config.timeoutClock;
+            matchConfig.gridSize = config.gridSize;
+            matchConfig.pool = pool ? &pool.value() : nullptr;
+            if(!cpuSets.empty()){
+                matchConfig.cpus = cpuSets[thread / static_cast<unsigned>(config.matchesPerCore) % cpuSets.size()];
+            }
+
+            results[m] = playMatch(matchConfig);
+
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << "[" << m + 1 << "/" << pairings.size() << "] "
+            << matchName(names, p, " vs ") << " (seed " << p.seed << "): "
+            << results[m].endReason << std::endl;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    unsigned threadCount = std::max(1u, config.threads);
+    std::vector<std::thread> workers;
+    for(unsigned t = 0; t < threadCount; ++t){
+        workers.emplace_back(worker, t);
+    }
+    for(std::thread& t : workers){
+        t.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    //Aggregate the results
+    std::vector<Standing> standings(sources.size());
+    std::vector<std::vector<std::chrono::microseconds>> responseTimes(sources.size());
+    for(std::size_t m = 0; m < pairings.size(); ++m){
+        const Pairing& p = pairings[m];
+        int winner = results[m].winner;
+        for(std::size_t seat = 0; seat < p.bots.size(); ++seat){
+            if(seat < results[m].responseTimes.size()){
+                const std::vector<std::chrono::microseconds>& times = results[m].responseTimes[seat];
+                responseTimes[p.bots[seat]].insert(responseTimes[p.bots[seat]].end(), times.begin(), times.end());
+            }
+            Standing& s = standings[p.bots[seat]];
+            s.played++;
+            if(winner == -1){
+                s.ties++;
+            }
+            else if(static_cast<std::size_t>(winner) == seat){
+                s.wins++;
+            }
+            else{
+                s.losses++;
+            }
+        }
+    }
+
+    std::vector<std::size_t> order(sources.size());
+    for(std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b){
+        return standings[a].points() > standings[b].points();
+    });
+
+    std::ofstream table((fs::path(config.outDir) / "results.txt").string());
+    std::ostream* outputs[] = {&std::cout, &table};
+    for(std::ostream* os : outputs){
+        *os << std::left << std::setw(32) << "Bot" << std::right
+        << std::setw(8) << "Played" << std::setw(8) << "Wins" << std::setw(8) << "Losses"
+        << std::setw(8) << "Ties" << std::setw(8) << "Points" << '\n';
+        for(std::size_t i : order){
+            const Standing& s = standings[i];
+            *os << std::left << std::setw(32) << names[i] << std::right
+            << std::setw(8) << s.played << std::setw(8) << s.wins << std::setw(8) << s.losses
+            << std::setw(8) << s.ties << std::setw(8) << s.points() << '\n';
+        }
+        *os << pairings.size() << " matches in " << elapsed.count() << " s ("
+        << static_cast<double>(pairings.size()) * 3600.0 / elapsed.count() << " matches/hour, "
+        << threadCount << " threads";
+        if(!cpuSets.empty()){
+            *os << ", " << config.matchesPerCore << " per set of " << cpuSets[0].size() << " cores";
+        }
+        *os << ")\n";
+
+        *os << '\n' << std::left << std::setw(32) << "Response times (ms)" << std::right
+        << std::setw(8) << "Turns" << std::setw(10) << "Median" << std::setw(10) << "p99"
+        << std::setw(10) << "Max" << std::setw(10) << "Std dev" << '\n';
+        for(std::size_t i : order){
+            LatencyStats stats = latencyStats(responseTimes[i]);
+            *os << std::left << std::setw(32) << names[i] << std::right << std::fixed << std::setprecision(3)
+            << std::setw(8) << stats.turns << std::setw(10) << stats.median << std::setw(10) << stats.p99
+            << std::setw(10) << stats.max << std::setw(10) << stats.stdDev << '\n' << std::defaultfloat;
+        }
+    }
+
+    return 0;
+}
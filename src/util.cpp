@@ -1,12 +1,30 @@
 #include <boost/asio.hpp>
 #include <boost/process.hpp>
-#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/system.hpp>
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <cerrno>
 #include <optional>
+#include <vector>
+#include <chrono>
 #include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <ctime>
+#include <limits>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <unistd.h>
 
 #include "../include/util.h"
 
@@ -14,73 +32,362 @@ namespace bp = boost::process;
 namespace asio = boost::asio;
 using namespace std::string_literals;
 
-void buildCpp(std::string code_path, std::string out_name){
-    std::string cmd {"g++ -std=c++20 -o bin/"s + out_name + " " + code_path};
+namespace {
+
+const std::string compileFlags {"-std=c++20"};
+
+//64 bit FNV-1a, good enough to tell bot sources apart
+std::uint64_t fnv1a(std::string_view data, std::uint64_t hash = 0xcbf29ce484222325ULL){
+    for(unsigned char c : data){
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
 
-    int status = system(cmd.c_str());
+//`text` quoted for the shell, whatever characters it holds
+std::string shellQuote(const std::string& text){
+    std::string quoted {"'"};
+    for(char c : text){
+        quoted += c == '\'' ? "'\\''"s : std::string(1, c);
+    }
+    return quoted + "'";
+}
+
+//Output of `g++ --version`, so that upgrading the compiler invalidates the cache
+const std::string& compilerVersion(){
+    static const std::string version = [](){
+        std::string out;
+        FILE* pipe = popen("g++ --version", "r");
+        if(pipe == nullptr){
+            return out;
+        }
+        char buf[256];
+        std::size_t n;
+        while((n = fread(buf, 1, sizeof(buf), pipe)) > 0){
+            out.append(buf, n);
+        }
+        pclose(pipe);
+        return out;
+    }();
+    return version;
+}
 
-    if(status == -1){
-        perror("system");
+} // namespace
+
+std::string buildCpp(std::string code_path, bool plugin){
+    const std::string flags = plugin ? compileFlags + " -shared -fPIC" : compileFlags;
+
+    std::ifstream src(code_path, std::ios::binary);
+    if(!src.is_open()){
+        std::cerr << "Error opening bot source: " << code_path << '\n';
+        std::exit(2);
+    }
+    std::stringstream contents;
+    contents << src.rdbuf();
+
+    //Key: compiler version + flags + source
+    std::uint64_t hash = fnv1a(compilerVersion());
+    hash = fnv1a(flags, hash);
+    hash = fnv1a(contents.str(), hash);
+
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash;
+    std::filesystem::create_directories(cacheDir);
+    std::string binary = cacheDir + "/" + name.str() + (plugin ? ".so" : "");
+
+    //Hold an exclusive lock while checking and filling this cache entry so that
+    //matches starting at the same time compile each bot only once
+    std::string lockPath = binary + ".lock";
+    int lockFd = open(lockPath.c_str(), O_CREAT | O_RDWR, 0644);
+    if(lockFd == -1 || flock(lockFd, LOCK_EX) == -1){
+        perror("flock");
         std::exit(2);
     }
-    if(WIFEXITED(status)){
-        if(WEXITSTATUS(status) != 0){
-            std::cerr << "g++ exited with status code: " << WEXITSTATUS(status) << '\n';
+
+    if(!std::filesystem::exists(binary)){
+        //Compile to a private file and rename it into place, so a half written
+        //binary is never visible under the cache name
+        std::string tmp = binary + ".tmp" + std::to_string(getpid());
+        std::string cmd {"g++ "s + flags + " -o " + shellQuote(tmp) + " " + shellQuote(code_path)};
+
+        int status = system(cmd.c_str());
+
+        if(status == -1){
+            perror("system");
+            std::exit(2);
+        }
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+            //The compiler failed or was killed, what it left (if anything) is not a bot
+            std::error_code ignored;
+            std::filesystem::remove(tmp, ignored);
+            if(WIFEXITED(status)){
+                std::cerr << "g++ exited with status code: " << WEXITSTATUS(status) << '\n';
+            }
+            else{
+                std::cerr << "g++ was killed by signal " << WTERMSIG(status) << " building " << code_path << '\n';
+            }
             std::exit(3);
         }
+        std::filesystem::rename(tmp, binary);
     }
+
+    flock(lockFd, LOCK_UN);
+    close(lockFd);
+    return binary;
 }
 
-std::optional<std::string> readPipeDeadline(bp::async_pipe &readPipe, asio::io_context &ctx,
-                      boost::posix_time::seconds deadline) {
-    std::string input;
+int writePipe(bp::pipe& pipe, std::string_view data){
+    return writePipesDeadline({&pipe}, {data}, std::chrono::steady_clock::time_point::max())[0];
+}
+
+std::vector<int> writePipesDeadline(const std::vector<bp::pipe*>& pipes, const std::vector<std::string_view>& data,
+                                    std::chrono::steady_clock::time_point deadline){
+    std::vector<int> syscalls(pipes.size(), 0);
+    std::vector<std::string_view> left(data);
+
+    //Writes what pipe i takes without waiting, returns false if it is broken
+    auto writeSome = [&](std::size_t i){
+        while(!left[i].empty()){
+            ssize_t written = ::write(pipes[i]->native_sink(), left[i].data(), left[i].size());
+            syscalls[i]++;
+            if(written == -1){
+                if(errno == EINTR){
+                    continue;
+                }
+                return errno == EAGAIN; //Full, waited for below
+            }
+            left[i].remove_prefix(static_cast<std::size_t>(written));
+        }
+        return true;
+    };
+
+    std::vector<std::size_t> ready(pipes.size());
+    for(std::size_t i = 0; i < ready.size(); ++i){
+        ready[i] = i;
+    }
+    std::vector<pollfd> full;
+    std::vector<std::size_t> fullPipes; //fullPipes[k] is the pipe of full[k]
+    while(true){
+        for(std::size_t i : ready){
+            if(!writeSome(i)){
+                syscalls[i] = -1;
+            }
+        }
+        full.clear();
+        fullPipes.clear();
+        for(std::size_t i = 0; i < pipes.size(); ++i){
+            if(!left[i].empty() && syscalls[i] != -1){
+                full.push_back({pipes[i]->native_sink(), POLLOUT, 0});
+                fullPipes.push_back(i);
+            }
+        }
+        if(full.empty()){
+            return syscalls;
+        }
+
+        //Wait for the bots to read, until the deadline
+        int timeout = -1;
+        if(deadline != std::chrono::steady_clock::time_point::max()){
+            auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if(remaining.count() <= 0){
+                for(std::size_t i : fullPipes){
+                    syscalls[i] = -1;
+                }
+                return syscalls;
+            }
+            timeout = static_cast<int>(std::min<std::chrono::milliseconds::rep>(remaining.count(), std::numeric_limits<int>::max()));
+        }
+        if(poll(full.data(), full.size(), timeout) == -1 && errno != EINTR){
+            perror("poll");
+            std::exit(2);
+        }
+        ready.clear();
+        for(std::size_t k = 0; k < full.size(); ++k){
+            if(full[k].revents != 0){
+                ready.push_back(fullPipes[k]);
+            }
+        }
+    }
+}
+
+std::vector<int> availableCpus(){
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) == 0){
+        for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu){
+            if(CPU_ISSET(cpu, &set)){
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+bool pinToCpus(pid_t pid, const std::vector<int>& cpus){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int cpu : cpus){
+        CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(pid, sizeof(set), &set) == 0;
+}
+
+clockid_t processCpuClock(pid_t pid){
+    clockid_t clock;
+    if(clock_getcpuclockid(pid, &clock) != 0){
+        return -1;
+    }
+    return clock;
+}
+
+std::chrono::nanoseconds cpuTime(clockid_t clock){
+    timespec time;
+    if(clock_gettime(clock, &time) != 0){
+        return std::chrono::nanoseconds::zero();
+    }
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+std::vector<PipeReply> readPipesDeadline(const std::vector<bp::async_pipe*>& readPipes,
+                      asio::io_context &ctx, std::chrono::steady_clock::time_point start,
+                      std::chrono::milliseconds deadline, const std::vector<bool>& framed,
+                      const CpuBudget* cpu) {
+    std::vector<PipeReply> replies(readPipes.size());
+    std::vector<asio::streambuf> buffers(readPipes.size());
+    std::size_t pending = readPipes.size();
+    std::vector<bool> answered(readPipes.size()), overBudget(readPipes.size());
+
+    auto usedCpu = [&](std::size_t i){
+        return std::chrono::duration_cast<std::chrono::microseconds>(cpuTime(cpu->clocks[i]) - cpu->startTimes[i]);
+    };
+
+    for(PipeReply& reply : replies){
+        reply.latency = deadline;
+    }
 
     bool timedOut = false;
-    asio::deadline_timer timer(ctx);
-    timer.expires_from_now(boost::posix_time::seconds(deadline));
+    asio::steady_timer timer(ctx);
+    timer.expires_at(start + deadline);
 
     auto on_timeout = [&](boost::system::error_code ec){
         if(ec == asio::error::operation_aborted){
-            //Read has occurred first.
+            //All reads have occurred first.
             return;
         }
         timedOut = true;
-        readPipe.cancel();        
+        for(bp::async_pipe* pipe : readPipes){
+            pipe->cancel();
+        }
     };
     timer.async_wait(on_timeout);
 
-    auto handle_read = [&](const boost::system::error_code &ec, asio::streambuf &buf,
-    std::size_t n_bytes){
-        if(ec){
-            std::cerr << "Read error: " << ec.message() << std::endl;
+    //With a CPU limit the bots still answering are checked every tenth of it,
+    //and those that used it up are not waited for any longer
+    asio::steady_timer cpuTimer(ctx);
+    std::chrono::microseconds cpuCheckPeriod {};
+    std::function<void(boost::system::error_code)> on_cpu_check = [&](boost::system::error_code ec){
+        if(ec == asio::error::operation_aborted || pending == 0){
+            //Everyone has answered (the check may have been due already when the timer was cancelled)
             return;
         }
-        else{
-            //Read executed first.
-            std::istream is(&buf);
-            std::getline(is, input);
-            buf.consume(n_bytes);
+        for(std::size_t i = 0; i < readPipes.size(); ++i){
+            if(!answered[i] && !overBudget[i] && usedCpu(i) > cpu->limit.value()){
+                overBudget[i] = true;
+                readPipes[i]->cancel();
+            }
+        }
+        cpuTimer.expires_after(cpuCheckPeriod);
+        cpuTimer.async_wait(on_cpu_check);
+    };
+    if(cpu && cpu->limit){
+        cpuCheckPeriod = std::max<std::chrono::microseconds>(cpu->limit.value() / 10, std::chrono::milliseconds(1));
+        cpuTimer.expires_after(cpuCheckPeriod);
+        cpuTimer.async_wait(on_cpu_check);
+    }
+
+    //Returns false if the read of pipe i failed (and nothing was delivered)
+    auto read_ok = [&](std::size_t i, const boost::system::error_code &ec){
+        if(ec == asio::error::operation_aborted && (timedOut || overBudget[i])){
+            //Timer has expired (or the bot has used up its CPU time) and cancelled the read.
+            return false;
+        }
+        if(ec){
+            std::cerr << "Read error: " << ec.message() << std::endl;
+            return false;
         }
+        return true;
     };
 
-    asio::streambuf buffer;
-    asio::async_read_until(readPipe, buffer, '\n',
-    [&](auto ec, std::size_t n_bytes){
-        if(ec == asio::error::operation_aborted && timedOut){
-            //Timer has expired and cancelled the read.
+    auto handle_read = [&](std::size_t i, const boost::system::error_code &ec, std::size_t n_bytes){
+        replies[i].latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start
+        );
+        answered[i] = true;
+        pending--;
+        if(pending == 0){
+            //Everyone has answered, no need to wait for the deadline.
+            timer.cancel();
+            cpuTimer.cancel();
+        }
+
+        if(cpu){
+            replies[i].cpuTime = usedCpu(i);
+        }
+        if(!read_ok(i, ec) || (cpu && cpu->limit && replies[i].cpuTime > cpu->limit.value())){
+            return;
+        }
+        std::string input;
+        if(i < framed.size() && framed[i]){
+            input.assign(asio::buffers_begin(buffers[i].data()), asio::buffers_end(buffers[i].data()));
+            replies[i].line = std::move(input);
             return;
         }
-        else{
-            handle_read(ec, buffer, n_bytes);
+        std::istream is(&buffers[i]);
+        std::getline(is, input);
+        buffers[i].consume(n_bytes);
+        if(!input.empty()){
+            replies[i].line = std::move(input);
+        }
+    };
+
+    //The length of a frame is read first, then its payload
+    auto read_frame = [&](std::size_t i){
+        asio::async_read(*readPipes[i], buffers[i], asio::transfer_exactly(sizeof(std::uint32_t)),
+        [&, i](auto ec, std::size_t){
+            if(ec){
+                handle_read(i, ec, 0); //Which reports the error
+                return;
+            }
+            std::uint32_t length;
+            asio::buffer_copy(asio::buffer(&length, sizeof(length)), buffers[i].data());
+            buffers[i].consume(sizeof(length));
+            if(length > MAX_FRAME_SIZE){
+                //Not a move, and its payload would be read as the next frames: the bot gets no move
+                handle_read(i, asio::error::message_size, 0);
+                return;
+            }
+            asio::async_read(*readPipes[i], buffers[i], asio::transfer_exactly(length),
+            [&, i](auto ecPayload, std::size_t n_bytes){
+                handle_read(i, ecPayload, n_bytes);
+            });
+        });
+    };
+
+    //Arm every read before running the loop so they all race the same deadline
+    for(std::size_t i = 0; i < readPipes.size(); ++i){
+        if(i < framed.size() && framed[i]){
+            read_frame(i);
+            continue;
         }
-    });
+        asio::async_read_until(*readPipes[i], buffers[i], '\n',
+        [&, i](auto ec, std::size_t n_bytes){
+            handle_read(i, ec, n_bytes);
+        });
+    }
     ctx.run();
     ctx.restart();
 
-    if(input.empty()){
-        return std::nullopt;
-    }
-    else{
-        return input;
-    }
-}
\ No newline at end of file
+    return replies;
+}
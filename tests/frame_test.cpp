@@ -0,0 +1,109 @@
+//Checks how readPipesDeadline() and readChannelsDeadline() read the binary frames of protocol
+//versions 3 and 4: a frame longer than MAX_FRAME_SIZE (or than what the bot pushed to its ring)
+//must be a read error, not a move, and must not hold the read until the deadline.
+//Build and run with: make test
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+#include "../include/util.h"
+#include "../include/shm_channel.h"
+
+namespace {
+
+constexpr std::chrono::milliseconds DEADLINE {2000};
+constexpr std::uint32_t MOVE_SIZE = 5 * 4;
+
+int failures = 0;
+
+void check(bool ok, const char* what){
+    if(!ok){
+        std::cerr << "FAILED: " << what << '\n';
+        failures++;
+    }
+}
+
+//A frame of `payload` bytes which claims to have `length`
+std::string makeFrame(std::uint32_t length, std::uint32_t payload){
+    std::string frame(sizeof(length) + payload, '\0');
+    std::memcpy(frame.data(), &length, sizeof(length));
+    return frame;
+}
+
+//Writes a frame of `length` bytes, as a bot would
+void writeFrame(bp::async_pipe& pipe, std::uint32_t length){
+    std::string frame = makeFrame(length, length);
+    if(::write(pipe.native_sink(), frame.data(), frame.size()) != static_cast<ssize_t>(frame.size())){
+        perror("write");
+        std::exit(2);
+    }
+}
+
+//Pushes `frame` to the engine through the ring of `channel`, as a bot would
+void pushFrame(ShmChannel& channel, const std::string& frame){
+    if(!shmPush(channel.fromBot(), frame.data(), static_cast<std::uint32_t>(frame.size()))){
+        std::cerr << "The ring is full\n";
+        std::exit(2);
+    }
+}
+
+PipeReply readFrame(ShmChannel& channel){
+    std::vector<ShmChannel*> channels {&channel};
+    return readChannelsDeadline(channels, std::chrono::steady_clock::now(), DEADLINE)[0];
+}
+
+PipeReply readFrame(bp::async_pipe& pipe, asio::io_context& ctx){
+    std::vector<bp::async_pipe*> pipes {&pipe};
+    return readPipesDeadline(pipes, ctx, std::chrono::steady_clock::now(), DEADLINE, {true})[0];
+}
+
+} // namespace
+
+int main(){
+    asio::io_context ctx;
+
+    //A move frame is returned as it is
+    bp::async_pipe valid(ctx);
+    writeFrame(valid, MOVE_SIZE);
+    PipeReply reply = readFrame(valid, ctx);
+    check(reply.line && reply.line->size() == MOVE_SIZE, "a valid frame is read");
+
+    //An oversized frame followed by a valid one: the bot gets no move, and its payload is not
+    //read as an empty move with the next frame taken from the middle of it
+    bp::async_pipe oversized(ctx);
+    writeFrame(oversized, MAX_FRAME_SIZE + 1000);
+    writeFrame(oversized, MOVE_SIZE);
+    reply = readFrame(oversized, ctx);
+    check(!reply.line, "an oversized frame is a read error");
+    check(reply.latency < DEADLINE, "an oversized frame is rejected before the deadline");
+
+    //The same through shared memory, where the frame must also not be popped
+    ShmChannel validChannel;
+    pushFrame(validChannel, makeFrame(MOVE_SIZE, MOVE_SIZE));
+    reply = readFrame(validChannel);
+    check(reply.line && reply.line->size() == MOVE_SIZE, "a valid frame is popped");
+
+    ShmChannel oversizedChannel;
+    pushFrame(oversizedChannel, makeFrame(MAX_FRAME_SIZE + 1000, MAX_FRAME_SIZE + 1000));
+    pushFrame(oversizedChannel, makeFrame(MOVE_SIZE, MOVE_SIZE));
+    reply = readFrame(oversizedChannel);
+    check(!reply.line, "an oversized frame in the ring is a read error");
+    check(oversizedChannel.fromBot().tail.load() == 0, "an oversized frame is not popped");
+
+    //A length past what was pushed would have the engine read beyond the frame
+    ShmChannel truncatedChannel;
+    pushFrame(truncatedChannel, makeFrame(MOVE_SIZE, 4));
+    reply = readFrame(truncatedChannel);
+    check(!reply.line, "a frame longer than what was pushed is a read error");
+    check(truncatedChannel.fromBot().tail.load() == 0, "a frame longer than what was pushed is not popped");
+
+    if(failures == 0){
+        std::cout << "frame_test: OK\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
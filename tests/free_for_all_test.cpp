@@ -0,0 +1,78 @@
+//Checks that in a free-for-all a bot that fails to send a move is eliminated on its own:
+//the moves the other players sent that turn are still played.
+//Build and run with: make test
+
+#include <iostream>
+#include <array>
+#include <string>
+#include <string_view>
+#include <filesystem>
+
+#include "../include/engine.h"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what){
+    if(!ok){
+        std::cerr << "FAILED: " << what << '\n';
+        failures++;
+    }
+}
+
+//A move of `player` to a free cell next to it, with no bomb or attack
+std::string freeMove(const Engine& engine, int player, int& x, int& y){
+    constexpr std::array<std::string_view, 4> names {"UP", "DOWN", "LEFT", "RIGHT"};
+    constexpr int dx[4] = {0, 0, -1, 1};
+    constexpr int dy[4] = {-1, 1, 0, 0};
+    const Game& game = engine.getGame();
+    for(std::size_t dir = 0; dir < names.size(); dir++){
+        x = game.getX(player) + dx[dir];
+        y = game.getY(player) + dy[dir];
+        if(Game::isValidPosition(x, y) && game.getCell(x, y) == '.'){
+            return "MOVE " + std::string(names[dir]) + " BOMB -1 -1 ATTACK -1 -1";
+        }
+    }
+    std::cerr << "Player " << player + 1 << " cannot move\n";
+    std::exit(2);
+}
+
+} // namespace
+
+int main(){
+    constexpr int PLAYERS = 4;
+    std::string logsPath = (std::filesystem::temp_directory_path() / "free_for_all_test.json").string();
+    {
+        Engine engine(logsPath, 1, PLAYERS);
+
+        //Player 1 fails to answer, the others move
+        std::array<std::string, MAX_PLAYERS> lines;
+        std::array<std::string_view, MAX_PLAYERS> inputs {};
+        std::array<int, MAX_PLAYERS> xs {}, ys {};
+        for(int player = 1; player < PLAYERS; player++){
+            lines[player] = freeMove(engine, player, xs[player], ys[player]);
+            inputs[player] = lines[player];
+        }
+        std::array<bool, MAX_PLAYERS> readErrors {};
+        readErrors[0] = true;
+        engine.outputReadError(readErrors);
+        check(!engine.isGameOver(), "the game goes on");
+        engine.processTurn(inputs);
+
+        check(engine.isEliminated(0), "the player at fault is eliminated");
+        check(engine.getCurrentTurn() == 1, "the turn is played once");
+        for(int player = 1; player < PLAYERS; player++){
+            check(!engine.isEliminated(player), "the other players are still in the game");
+            check(engine.getGame().getX(player) == xs[player] && engine.getGame().getY(player) == ys[player],
+                  "the moves of the other players are played");
+        }
+        check(!engine.isGameOver(), "the game goes on after the turn");
+    }
+    std::filesystem::remove(logsPath);
+
+    if(failures == 0){
+        std::cout << "free_for_all_test: OK\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+//Converts a binary game log (.cglog) back to the JSON log format.
+//Usage: ./tools/bin/log2json game.cglog game.json
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "../include/binary_log.h"
+#include "../include/log_writer.h"
+
+int main(int argc, char* argv[]){
+    if(argc != 3){
+        std::cerr << "Usage: ./tools/bin/log2json game.cglog game.json\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if(!in.is_open()){
+        std::cerr << "Error opening logs file: " << argv[1] << '\n';
+        return 1;
+    }
+    BinaryLogReader reader(in);
+    if(!reader.isValid()){
+        std::cerr << argv[1] << " is not a binary game log\n";
+        return 1;
+    }
+
+    JsonLogWriter writer(argv[2]);
+    std::string grid;
+    TurnRecord turn;
+    for(auto entry = reader.next(grid, turn); entry != BinaryLogReader::Entry::END; entry = reader.next(grid, turn)){
+        if(entry == BinaryLogReader::Entry::GRID){
+            writer.writeGrid(grid, reader.getPlayerCount());
+        }
+        else{
+            writer.writeTurn(turn);
+        }
+    }
+    writer.finish();
+    return 0;
+}